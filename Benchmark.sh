@@ -0,0 +1,118 @@
+#!/bin/bash
+
+# Benchmark of the compute engines of Version 1.  Every combination of the
+# settings below is run headless (see --generations in main.c), and one line
+# of results per run is printed as CSV (default) or JSON:  generations/s,
+# cells/s, latency percentiles of a generation, and the parallel efficiency
+# (speedup over the same run with 1 thread, divided by the thread count;
+# empty if the thread counts don't start with 1).
+#
+#	./Benchmark.sh [csv|json] > results.csv
+#
+# The settings can be changed through the environment, e.g.
+#
+#	SIZES="1024 4096" THREADS="1 8" ENGINES="simd bits" ./Benchmark.sh json
+
+format=${1:-csv}
+sizes=${SIZES:-"256 1024 2048"}
+threadCounts=${THREADS:-"1 2 4 8"}
+engines=${ENGINES:-"scalar simd bits hashlife"}
+rules=${RULES:-"B3/S23 B36/S23"}
+colors=${COLORS:-"off on"}
+frames=${FRAMES:-"dead wrap"}
+generations=${GENERATIONS:-200}
+
+if [ "$format" != "csv" ] && [ "$format" != "json" ] ;
+	then
+	echo "Usage: ./Benchmark.sh [csv|json]" >&2
+	exit 1
+fi
+
+cd "Version 1"
+
+if ! gcc -O2 *.c -lGL -lglut -lpthread -o cell; then
+	echo "Failed to compile program." >&2
+	exit 1
+fi
+
+
+# cells/s of the 1-thread runs, by engine, size, rule, color and frame
+declare -A baseline
+
+first=1
+[ "$format" == "json" ] && echo "["
+
+for engine in $engines ; do
+for size in $sizes ; do
+for rule in $rules ; do
+for color in $colors ; do
+for frame in $frames ; do
+
+	# hashlife runs on an unbounded plane, in black and white, and cannot do B0
+	if [ "$engine" == "hashlife" ] ;
+		then
+		if [ "$frame" != "dead" ] || [ "$color" != "off" ] || [[ "$rule" =~ ^B0 ]] ;
+			then
+			continue
+		fi
+		frameOption=""
+	else
+		frameOption="--frame $frame"
+	fi
+
+	for threads in $threadCounts ; do
+		if [ "$threads" -gt "$size" ] ;
+			then
+			continue
+		fi
+
+		output=$(./cell $size $size $threads --engine $engine --rule $rule --color $color $frameOption \
+					--generations $generations --report csv)
+		header=$(echo "$output" | tail -n 2 | head -n 1)
+		values=$(echo "$output" | tail -n 1)
+
+		key="$engine $size $rule $color $frame"
+		cellsPerSecond=$(echo "$values" | cut -d, -f14)
+		if [ "$threads" == "1" ] ;
+			then
+			baseline[$key]=$cellsPerSecond
+		fi
+		efficiency=$(awk -v c="$cellsPerSecond" -v b="${baseline[$key]}" -v t="$threads" \
+						'BEGIN { if (b != "" && b > 0) printf "%.3f", c / (t * b) }')
+
+		if [ "$format" == "csv" ] ;
+			then
+			[ $first == 1 ] && echo "$header,efficiency"
+			echo "$values,$efficiency"
+		else
+			# one object per run, with the same names as the CSV columns
+			[ $first == 0 ] && echo ","
+			echo "$header,efficiency" | awk -F, -v values="$values,$efficiency" '
+				{
+					split(values, v, ",")
+					line = "  {"
+					for (k = 1; k <= NF; k++)
+					{
+						if (v[k] == "")
+							v[k] = "null"
+						else if ($k == "engine" || $k == "simd" || $k == "rule" || $k == "color" || $k == "frame")
+							v[k] = "\"" v[k] "\""
+						line = line (k > 1 ? ", " : "") "\"" $k "\": " v[k]
+					}
+					printf "%s}", line
+				}'
+		fi
+		first=0
+	done
+
+done
+done
+done
+done
+done
+
+if [ "$format" == "json" ] ;
+	then
+	echo ""
+	echo "]"
+fi
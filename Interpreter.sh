@@ -34,7 +34,7 @@ progDirectory=$(pwd)
 
 # attempt to compile the program in the current directory (either version 1 or version 2)
 # then execute the program if successful
-if gcc main.c gl_frontEnd.c -lGL -lglut -lpthread -o cell; then
+if gcc *.c -lGL -lglut -lpthread -o cell; then
 	echo "Successfully compiled program."
 	./cell $rows $columns $threads &
 else
@@ -77,6 +77,56 @@ while : ; do
 		printf "rule is now 4: Maze Generation\n"
 		echo "rule 4">prog04pipe
 
+	# any other B/S rule string, e.g. "rule B36/S23" (validated by the program)
+	elif [[ "$varInput" =~ ^rule\ [BbSs0-8]*/[BbSs0-8]*$ ]] ;
+	then
+		printf "rule is now ${varInput#rule }\n"
+		echo "${varInput}">prog04pipe
+
+	# behavior at the border of the frame (Version 1), e.g. "frame wrap"
+	elif [[ "$varInput" =~ ^frame\ (dead|wrap|clipped|random)$ ]] ;
+	then
+		if [ "$version" == "1" ] ;
+		then
+			printf "frame is now ${varInput#frame }\n"
+			echo "${varInput}">prog04pipe
+		else
+			printf "Version 2 picks its frame behavior at compile time (FRAME_BEHAVIOR in main.c).\n"
+		fi
+
+	# restart the random generators from a seed and reset the grid (Version 2), e.g. "seed 42"
+	elif [[ "$varInput" =~ ^seed\ [0-9]+$ ]] ;
+	then
+		printf "seed is now ${varInput#seed }\n"
+		echo "${varInput}">prog04pipe
+
+	# update count stats of Version 2 (started with --count-updates), printed by the program
+	elif [ "$varInput" == "stats" ] ;
+	then
+		echo "stats">prog04pipe
+
+	# how a grid larger than the pane is drawn, e.g. "render density"
+	elif [[ "$varInput" =~ ^render\ (maxage|density)$ ]] ;
+	then
+		printf "render mode is now ${varInput#render }\n"
+		echo "${varInput}">prog04pipe
+
+	# part of the grid shown:  "zoom 4" (around the center, less than 1 zooms out),
+	# "pan -100 250" (rows, columns), "view 5000 5000 100" (center row, column, zoom)
+	# or "view reset" (whole grid)
+	elif [[ "$varInput" =~ ^zoom\ [0-9]+(\.[0-9]*)?$ ]] ||
+		 [[ "$varInput" =~ ^pan\ -?[0-9]+(\.[0-9]*)?\ -?[0-9]+(\.[0-9]*)?$ ]] ||
+		 [[ "$varInput" =~ ^view\ ([0-9]+(\.[0-9]*)?\ [0-9]+(\.[0-9]*)?\ [0-9]+(\.[0-9]*)?|reset)$ ]] ;
+	then
+		printf "viewport: ${varInput}\n"
+		echo "${varInput}">prog04pipe
+
+	# frames per second the display aims at, whatever the compute rate, e.g. "fps 30"
+	elif [[ "$varInput" =~ ^fps\ [0-9]+(\.[0-9]*)?$ ]] ;
+	then
+		printf "target frame rate is now ${varInput#fps }\n"
+		echo "${varInput}">prog04pipe
+
 	elif [ "$varInput" == "color on" ] ;
 	then
 		printf "Color: ON\n"
@@ -89,14 +139,26 @@ while : ; do
 
 	elif [ "$varInput" == "speedup" ] ;
 	then
-		printf "Speeding up generation by 5000 mu\n"
+		printf "Speeding up generation (Version 1: by 5000 mu, Version 2: twice the update rate)\n"
 		echo "speedup">prog04pipe
 
 	elif [ "$varInput" == "slowdown" ] ;
 	then
-		printf "Slowing down generation by 5000 mu\n"
+		printf "Slowing down generation (Version 1: by 5000 mu, Version 2: half the update rate)\n"
 		echo "slowdown">prog04pipe
 
+	# target rate of cell updates (Version 2), e.g. "rate 50000" or "rate max"
+	elif [[ "$varInput" =~ ^rate\ ([0-9]+(\.[0-9]*)?|max)$ ]] ;
+	then
+		printf "rate is now ${varInput#rate }\n"
+		echo "${varInput}">prog04pipe
+
+	# target rate in sweeps of the whole grid per second (Version 2), e.g. "sweeps 2.5"
+	elif [[ "$varInput" =~ ^sweeps\ [0-9]+(\.[0-9]*)?$ ]] ;
+	then
+		printf "rate is now ${varInput#sweeps } sweeps/s\n"
+		echo "${varInput}">prog04pipe
+
 	else
 		printf "Invalid Command.\n"
 	fi
@@ -0,0 +1,148 @@
+//
+//  activeTiles.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+//
+#include "activeTiles.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+//	One flag per tile:
+//		- changedPrev:  the tile changed while computing the current generation
+//		- changedNext:  the tile changed while computing the next generation
+//	The row blocks the threads get (see workScheduler.h) are shorter than a
+//	tile, so several threads may mark the same tile of changedNext during a
+//	generation:  its flags are atomic (relaxed stores, as they only go from
+//	0 to 1 and are read after the barrier).  changedPrev is only written
+//	while the threads wait at the barrier.
+static atomic_uchar* changedPrev;
+static atomic_uchar* changedNext;
+
+static unsigned int numTileRows, numTileCols;
+
+static int borderAlwaysActive = 0;
+static int wrapAround = 0;
+
+//	Set when every tile must be recomputed, applied at the next swap
+static volatile int allTilesChanged = 0;
+
+
+void initializeActiveTiles(unsigned int numRows, unsigned int numCols)
+{
+	numTileRows = (numRows + TILE_SIZE - 1) / TILE_SIZE;
+	numTileCols = (numCols + TILE_SIZE - 1) / TILE_SIZE;
+
+	changedPrev = (atomic_uchar*) malloc(numTileRows*numTileCols*sizeof(atomic_uchar));
+	changedNext = (atomic_uchar*) calloc(numTileRows*numTileCols, sizeof(atomic_uchar));
+	memset(changedPrev, 1, numTileRows*numTileCols);
+}
+
+void freeActiveTiles(void)
+{
+	free(changedPrev);
+	free(changedNext);
+}
+
+unsigned int getNumTileRows(void)
+{
+	return numTileRows;
+}
+
+unsigned int getNumTileCols(void)
+{
+	return numTileCols;
+}
+
+/*
+ * A tile must be computed if it, or one of its 8 neighbors, changed during
+ * the last generation
+ */
+int tileIsActive(unsigned int tileRow, unsigned int tileCol)
+{
+	if (borderAlwaysActive && (tileRow == 0 || tileRow == numTileRows-1 ||
+							   tileCol == 0 || tileCol == numTileCols-1))
+		return 1;
+
+	for (int di=-1; di<=1; di++)
+	{
+		int i = (int) tileRow + di;
+		if (wrapAround)
+			i = (i + numTileRows) % numTileRows;
+		else if (i < 0 || i >= (int) numTileRows)
+			continue;
+
+		for (int dj=-1; dj<=1; dj++)
+		{
+			int j = (int) tileCol + dj;
+			if (wrapAround)
+				j = (j + numTileCols) % numTileCols;
+			else if (j < 0 || j >= (int) numTileCols)
+				continue;
+
+			if (atomic_load_explicit(&changedPrev[i*numTileCols + j], memory_order_relaxed))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+void markTileChanged(unsigned int tileRow, unsigned int tileCol)
+{
+	atomic_store_explicit(&changedNext[tileRow*numTileCols + tileCol], 1, memory_order_relaxed);
+}
+
+/*
+ * Forces every tile to be computed, starting with the generation that follows
+ * the next swap.  Needed whenever the grid is changed from outside (reset) or
+ * the outcome of a generation changes for the same input (new rule, color
+ * mode toggled).  Can be called from any thread.
+ */
+void markAllTilesChanged(void)
+{
+	allTilesChanged = 1;
+}
+
+//	With random borders, the border tiles change every generation no matter what
+void setBorderTilesAlwaysActive(int alwaysActive)
+{
+	borderAlwaysActive = alwaysActive;
+}
+
+//	When the frame wraps around, the tiles on opposite sides are neighbors
+void setTilesWrapAround(int wrap)
+{
+	wrapAround = wrap;
+}
+
+/*
+ * Called once per generation, when the grids are swapped.  Returns the
+ * number of tiles that changed during the generation just computed.
+ */
+unsigned int swapTileFlags(void)
+{
+	atomic_uchar* temp = changedPrev;
+	unsigned int numChanged = 0;
+
+	changedPrev = changedNext;
+	changedNext = temp;
+	memset(changedNext, 0, numTileRows*numTileCols);
+
+	for (unsigned int t=0; t<numTileRows*numTileCols; t++)
+		numChanged += changedPrev[t];
+
+	if (allTilesChanged)
+	{
+		allTilesChanged = 0;
+		memset(changedPrev, 1, numTileRows*numTileCols);
+	}
+
+	return numChanged;
+}
@@ -0,0 +1,39 @@
+//
+//  activeTiles.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef ACTIVE_TILES_H
+#define ACTIVE_TILES_H
+
+//-----------------------------------------------------------------------------
+//	Active-region tracking.  The grid is cut into TILE_SIZE x TILE_SIZE
+//	tiles, and we remember which tiles changed during the last generation.
+//	A tile whose 3x3 block of tiles did not change at all is going to stay
+//	the same, so it doesn't need to be computed:  the "next" grid already
+//	holds the same values as the current one for that tile (it was either
+//	computed with no change or left as-is one generation earlier).
+//-----------------------------------------------------------------------------
+
+//	A multiple of 64, so that a tile is a whole number of bit-grid words
+#define TILE_SIZE	64
+
+void initializeActiveTiles(unsigned int numRows, unsigned int numCols);
+void freeActiveTiles(void);
+
+unsigned int getNumTileRows(void);
+unsigned int getNumTileCols(void);
+
+int tileIsActive(unsigned int tileRow, unsigned int tileCol);
+void markTileChanged(unsigned int tileRow, unsigned int tileCol);
+
+void markAllTilesChanged(void);
+void setBorderTilesAlwaysActive(int alwaysActive);
+void setTilesWrapAround(int wrap);
+
+unsigned int swapTileFlags(void);
+
+
+#endif // ACTIVE_TILES_H
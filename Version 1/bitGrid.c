@@ -0,0 +1,327 @@
+//
+//  bitGrid.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+#include <string.h>
+//
+#include "bitGrid.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+//	Same idea as currentGrid/nextGrid in main.c:  we read from the current
+//	bit grid and write the next generation into the other one.
+//	Each grid has a halo, like the byte grids:  rows -1 and bitRows exist,
+//	and every row has one word in front of it (the halo cell of column -1
+//	is its top bit) and one word after it (so that the halo cell of column
+//	bitCols, bit bitCols%64 of word bitCols/64, always exists).
+static uint64_t* currentBits;
+static uint64_t* nextBits;
+
+static unsigned int bitRows, bitCols, wordsPerRow;
+
+//	number of words from one row to the next, halo words included
+static unsigned int rowStride;
+
+//	Mask of the valid bits in the last word of a row
+static uint64_t lastWordMask;
+
+
+void initializeBitGrid(unsigned int numRows, unsigned int numCols)
+{
+	bitRows = numRows;
+	bitCols = numCols;
+	wordsPerRow = (numCols + 63) / 64;
+
+	if (numCols % 64 == 0)
+		lastWordMask = ~(uint64_t) 0;
+	else
+		lastWordMask = ((uint64_t) 1 << (numCols % 64)) - 1;
+
+	rowStride = wordsPerRow + 2;
+	currentBits = (uint64_t*) calloc((size_t) (numRows+2)*rowStride, sizeof(uint64_t));
+	nextBits = (uint64_t*) calloc((size_t) (numRows+2)*rowStride, sizeof(uint64_t));
+}
+
+void freeBitGrid(void)
+{
+	free(currentBits);
+	free(nextBits);
+}
+
+//	Returns word 0 of row i (-1 <= i <= bitRows) of the given grid
+static inline uint64_t* bitRow(uint64_t* bits, int i)
+{
+	return bits + (size_t) (i+1)*rowStride + 1;
+}
+
+//	Reads/writes the bit of column j (-1 <= j <= bitCols) of a row
+static inline uint64_t getBit(const uint64_t* row, int j)
+{
+	return j < 0 ? row[-1] >> 63 : (row[j/64] >> (j%64)) & 1;
+}
+
+static inline void setBit(uint64_t* row, int j, uint64_t bit)
+{
+	if (j < 0)
+		row[-1] = bit << 63;
+	else
+		row[j/64] = (row[j/64] & ~((uint64_t) 1 << (j%64))) | (bit << (j%64));
+}
+
+/*
+ * Packs a byte grid (0 = dead, anything else = alive) into the current bit grid
+ */
+void bitGridImport(uint8_t** grid)
+{
+	for (unsigned int i=0; i<bitRows; i++)
+	{
+		uint64_t* row = bitRow(currentBits, i);
+		memset(row, 0, wordsPerRow*sizeof(uint64_t));
+		for (unsigned int j=0; j<bitCols; j++)
+		{
+			if (grid[i][j] != 0)
+				row[j/64] |= (uint64_t) 1 << (j%64);
+		}
+	}
+}
+
+/*
+ * Unpacks the current bit grid into a byte grid (0 = dead, 1 = alive)
+ */
+void bitGridExport(uint8_t** grid)
+{
+	bitGridExportRegion(grid, 0, bitRows, 0, bitCols);
+}
+
+//	Same, for the cells of rows [startRow, endRow) and columns [startCol, endCol) only
+void bitGridExportRegion(uint8_t** grid, unsigned int startRow, unsigned int endRow,
+						 unsigned int startCol, unsigned int endCol)
+{
+	for (unsigned int i=startRow; i<endRow; i++)
+	{
+		const uint64_t* row = bitRow(currentBits, i);
+		for (unsigned int j=startCol; j<endCol; j++)
+		{
+			grid[i][j] = (uint8_t) ((row[j/64] >> (j%64)) & 1);
+		}
+	}
+}
+
+/*
+ * Fills the halo of the current bit grid.  With wrap set, the halo holds
+ * the cells of the opposite side of the grid (torus).  Otherwise, random
+ * set gives it new random cells, and with neither it is dead.
+ * Must be called after every import and swap.
+ */
+void bitGridRefreshHalo(int wrap, int random)
+{
+	for (unsigned int i=0; i<bitRows; i++)
+	{
+		uint64_t* row = bitRow(currentBits, i);
+
+		//	also clears the halo word after the row and what follows the last column
+		row[wordsPerRow-1] &= lastWordMask;
+		row[wordsPerRow] = 0;
+		if (wrap)
+		{
+			setBit(row, -1, getBit(row, bitCols-1));
+			setBit(row, bitCols, getBit(row, 0));
+		}
+		else
+		{
+			setBit(row, -1, random ? (uint64_t) (rand() % 2) : 0);
+			setBit(row, bitCols, random ? (uint64_t) (rand() % 2) : 0);
+		}
+	}
+
+	//	rows -1 and bitRows, halo words (and so the corners) included
+	uint64_t* top = bitRow(currentBits, -1) - 1;
+	uint64_t* bottom = bitRow(currentBits, bitRows) - 1;
+	if (wrap)
+	{
+		memcpy(top, bitRow(currentBits, bitRows-1) - 1, rowStride*sizeof(uint64_t));
+		memcpy(bottom, bitRow(currentBits, 0) - 1, rowStride*sizeof(uint64_t));
+	}
+	else
+	{
+		memset(top, 0, rowStride*sizeof(uint64_t));
+		memset(bottom, 0, rowStride*sizeof(uint64_t));
+		if (random)
+		{
+			for (int j=-1; j<=(int) bitCols; j++)
+			{
+				setBit(top + 1, j, (uint64_t) (rand() % 2));
+				setBit(bottom + 1, j, (uint64_t) (rand() % 2));
+			}
+		}
+	}
+}
+
+/*
+ * Writes zeros over rows [startRow, endRow) of both bit grids, so that the
+ * calling thread is the first to touch their pages (see numaPlacement.h)
+ */
+void bitGridTouchRows(unsigned int startRow, unsigned int endRow)
+{
+	size_t length = (size_t) (endRow - startRow)*rowStride*sizeof(uint64_t);
+
+	memset(bitRow(currentBits, startRow) - 1, 0, length);
+	memset(bitRow(nextBits, startRow) - 1, 0, length);
+}
+
+//	Start and length of rows [startRow, endRow) of the current bit grid
+size_t bitGridRowsMemory(unsigned int startRow, unsigned int endRow, const void** start)
+{
+	*start = bitRow(currentBits, startRow) - 1;
+	return (size_t) (endRow - startRow)*rowStride*sizeof(uint64_t);
+}
+
+//	Shifts a row so that each bit position holds its west (column - 1) or
+//	east (column + 1) neighbor, pulling the missing bit from the adjacent
+//	word (the halo words at both ends of the row).
+static inline uint64_t westNeighbors(const uint64_t* row, unsigned int w)
+{
+	return (row[w] << 1) | (row[(int) w-1] >> 63);
+}
+
+static inline uint64_t eastNeighbors(const uint64_t* row, unsigned int w)
+{
+	return (row[w] >> 1) | (row[w+1] << 63);
+}
+
+/*
+ * Computes rows [startRow, endRow) of the next generation, 64 cells at a time.
+ * birthMask/surviveMask have bit k set if a cell with k live neighbors is
+ * born/survives.  Cells outside the grid are read from the halo.  If keepBorderDead
+ * is set, the cells on the border of the frame are forced dead (FRAME_DEAD).
+ */
+void bitGridRowsGeneration(unsigned int startRow, unsigned int endRow,
+						   unsigned int birthMask, unsigned int surviveMask,
+						   int keepBorderDead)
+{
+	bitGridTileGeneration(startRow, endRow, 0, wordsPerRow, birthMask, surviveMask, keepBorderDead);
+}
+
+/*
+ * Same as bitGridRowsGeneration, restricted to the words [startWord, endWord)
+ * of each row (word w holds columns 64*w to 64*w+63).  Returns 1 if any cell
+ * of that block differs from the current generation, 0 otherwise.
+ */
+int bitGridTileGeneration(unsigned int startRow, unsigned int endRow,
+						  unsigned int startWord, unsigned int endWord,
+						  unsigned int birthMask, unsigned int surviveMask,
+						  int keepBorderDead)
+{
+	uint64_t changed = 0;
+
+	if (endWord > wordsPerRow)
+		endWord = wordsPerRow;
+
+	for (unsigned int i=startRow; i<endRow; i++)
+	{
+		const uint64_t* up = bitRow(currentBits, (int) i-1);
+		const uint64_t* mid = bitRow(currentBits, i);
+		const uint64_t* down = bitRow(currentBits, i+1);
+		uint64_t* out = bitRow(nextBits, i);
+
+		if (keepBorderDead && (i == 0 || i == bitRows-1))
+		{
+			for (unsigned int w=startWord; w<endWord; w++)
+			{
+				changed |= (w == wordsPerRow-1) ? mid[w] & lastWordMask : mid[w];
+				out[w] = 0;
+			}
+			continue;
+		}
+
+		for (unsigned int w=startWord; w<endWord; w++)
+		{
+			uint64_t	uw = westNeighbors(up, w), uc = up[w], ue = eastNeighbors(up, w),
+						mw = westNeighbors(mid, w), me = eastNeighbors(mid, w),
+						dw = westNeighbors(down, w), dc = down[w], de = eastNeighbors(down, w);
+
+			//	Row above and row below:  3 inputs each -> 2-bit counts (full adders)
+			uint64_t u0 = uw ^ uc ^ ue,
+					 u1 = (uw & uc) | (ue & (uw ^ uc));
+			uint64_t d0 = dw ^ dc ^ de,
+					 d1 = (dw & dc) | (de & (dw ^ dc));
+			//	Own row:  2 inputs -> 2-bit count (half adder)
+			uint64_t m0 = mw ^ me,
+					 m1 = mw & me;
+
+			//	Add the three 2-bit counts into the 4-bit count s3 s2 s1 s0
+			uint64_t s0 = u0 ^ d0 ^ m0,
+					 c0 = (u0 & d0) | (m0 & (u0 ^ d0));
+			uint64_t x1 = u1 ^ d1 ^ m1,
+					 y1 = (u1 & d1) | (m1 & (u1 ^ d1));
+			uint64_t s1 = x1 ^ c0,
+					 c1 = x1 & c0;
+			uint64_t s2 = y1 ^ c1,
+					 s3 = y1 & c1;
+
+			//	Apply the rule:  OR together the "count == k" planes that the
+			//	rule selects for birth (dead cells) and survival (live cells)
+			uint64_t born = 0, keep = 0;
+			for (unsigned int k=0; k<=8; k++)
+			{
+				if (((birthMask | surviveMask) >> k) & 1)
+				{
+					uint64_t eq = ((k & 1) ? s0 : ~s0) & ((k & 2) ? s1 : ~s1) &
+								  ((k & 4) ? s2 : ~s2) & ((k & 8) ? s3 : ~s3);
+					if ((birthMask >> k) & 1)
+						born |= eq;
+					if ((surviveMask >> k) & 1)
+						keep |= eq;
+				}
+			}
+			//	what lies past the last column (the halo cell of column
+			//	bitCols, if it falls in this word) is never alive
+			uint64_t alive = (w == wordsPerRow-1) ? mid[w] & lastWordMask : mid[w];
+			uint64_t next = (born & ~alive) | (keep & alive);
+
+			//	clear what lies past the last column, and the left and right
+			//	borders if they are kept dead
+			if (w == wordsPerRow-1)
+				next &= lastWordMask;
+			if (keepBorderDead)
+			{
+				if (w == 0)
+					next &= ~(uint64_t) 1;
+				if (w == (bitCols-1)/64)
+					next &= ~((uint64_t) 1 << ((bitCols-1)%64));
+			}
+
+			out[w] = next;
+			changed |= next ^ alive;
+		}
+	}
+
+	return changed != 0;
+}
+
+//	Returns 1 if a cell of the given row of the next generation differs from
+//	the current one (the last word of the current row may also hold the halo
+//	cell of column bitCols, which is not compared)
+int bitGridRowChanged(unsigned int row)
+{
+	const uint64_t* next = bitRow(nextBits, row);
+	const uint64_t* current = bitRow(currentBits, row);
+
+	if (memcmp(next, current, (wordsPerRow-1)*sizeof(uint64_t)) != 0)
+		return 1;
+	return ((next[wordsPerRow-1] ^ current[wordsPerRow-1]) & lastWordMask) != 0;
+}
+
+//	Same as swapGrids() in main.c, for the bit grids
+void bitGridSwap(void)
+{
+	uint64_t* tempBits = currentBits;
+	currentBits = nextBits;
+	nextBits = tempBits;
+}
@@ -0,0 +1,48 @@
+//
+//  bitGrid.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef BIT_GRID_H
+#define BIT_GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+//	Bit-packed engine: each row of the grid is stored as an array of 64-bit
+//	words, one bit per cell (bit b of word w holds column 64*w + b).
+//	A whole word of cells is computed at once by adding the eight neighbor
+//	bit-planes with full adders, so the working set is 1 bit per cell
+//	instead of one byte per cell plus the 2D scaffold.
+//	This engine only tracks dead/alive:  cell "age" (color mode) is ignored.
+//	Like the byte grids, the bit grids are surrounded with a one-cell halo
+//	(see bitGridRefreshHalo) so the kernel never tests for the frame border.
+//-----------------------------------------------------------------------------
+
+void initializeBitGrid(unsigned int numRows, unsigned int numCols);
+void freeBitGrid(void);
+
+void bitGridImport(uint8_t** grid);
+void bitGridExport(uint8_t** grid);
+void bitGridExportRegion(uint8_t** grid, unsigned int startRow, unsigned int endRow,
+						 unsigned int startCol, unsigned int endCol);
+void bitGridRefreshHalo(int wrap, int random);
+
+void bitGridTouchRows(unsigned int startRow, unsigned int endRow);
+size_t bitGridRowsMemory(unsigned int startRow, unsigned int endRow, const void** start);
+
+void bitGridRowsGeneration(unsigned int startRow, unsigned int endRow,
+						   unsigned int birthMask, unsigned int surviveMask,
+						   int keepBorderDead);
+int bitGridTileGeneration(unsigned int startRow, unsigned int endRow,
+						  unsigned int startWord, unsigned int endWord,
+						  unsigned int birthMask, unsigned int surviveMask,
+						  int keepBorderDead);
+int bitGridRowChanged(unsigned int row);
+void bitGridSwap(void);
+
+
+#endif // BIT_GRID_H
@@ -0,0 +1,95 @@
+//
+//  displayFrames.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+#include <stdatomic.h>
+//
+#include "displayFrames.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+static DisplayFrame frames[3];
+
+//	Each index is only ever used by one side
+static unsigned int backIndex = 0, frontIndex = 1;
+
+//	Index of the middle frame, with NEW_FRAME_BIT set if it was published
+//	after the renderer last took one
+static _Atomic unsigned int middleState = 2;
+
+#define NEW_FRAME_BIT	4u
+#define INDEX_MASK		3u
+
+
+void initializeDisplayFrames(unsigned int numRows, unsigned int numCols)
+{
+	for (int f=0; f<3; f++)
+	{
+		frames[f].cells = (uint8_t*) calloc((size_t) numRows*numCols, sizeof(uint8_t));
+		frames[f].rows = (uint8_t**) malloc(numRows*sizeof(uint8_t*));
+		for (unsigned int i=0; i<numRows; i++)
+			frames[f].rows[i] = frames[f].cells + (size_t) i*numCols;
+		frames[f].rowChangedAt = (unsigned long*) calloc(numRows, sizeof(unsigned long));
+		frames[f].generation = 0;
+		frames[f].imageRows = numRows;
+		frames[f].imageCols = numCols;
+		frames[f].reduced = false;
+	}
+}
+
+void freeDisplayFrames(void)
+{
+	for (int f=0; f<3; f++)
+	{
+		free(frames[f].rowChangedAt);
+		free(frames[f].rows);
+		free(frames[f].cells);
+	}
+}
+
+/*
+ * True if the renderer has taken the last frame published.  Otherwise it
+ * hasn't drawn it yet, and there is no point in copying a new one:  this way
+ * a generation is copied at most once per frame actually displayed.
+ */
+bool frameWanted(void)
+{
+	return (atomic_load(&middleState) & NEW_FRAME_BIT) == 0;
+}
+
+//	True if a frame was published that the renderer hasn't taken yet
+bool newFrameAvailable(void)
+{
+	return !frameWanted();
+}
+
+//	The frame the compute side may write to, until the next publishFrame
+DisplayFrame* getBackFrame(void)
+{
+	return &frames[backIndex];
+}
+
+//	Makes the back frame the latest one, and gets the old middle frame as new back frame
+void publishFrame(unsigned long generation)
+{
+	frames[backIndex].generation = generation;
+	backIndex = atomic_exchange(&middleState, backIndex | NEW_FRAME_BIT) & INDEX_MASK;
+}
+
+/*
+ * Returns the latest complete frame published.  It stays untouched until the
+ * next call to getLatestFrame.
+ */
+const DisplayFrame* getLatestFrame(void)
+{
+	if (atomic_load(&middleState) & NEW_FRAME_BIT)
+		frontIndex = atomic_exchange(&middleState, frontIndex) & INDEX_MASK;
+
+	return &frames[frontIndex];
+}
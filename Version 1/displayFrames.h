@@ -0,0 +1,61 @@
+//
+//  displayFrames.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef DISPLAY_FRAMES_H
+#define DISPLAY_FRAMES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+//
+#include "gridReduction.h"
+#include "viewport.h"
+
+//-----------------------------------------------------------------------------
+//	Lock-free hand-off of finished generations from the compute threads to
+//	the renderer (triple buffering).  There are three copies of the grid:
+//		- the back frame, that the compute side fills,
+//		- the front frame, that the renderer draws,
+//		- the middle frame, the latest one published.
+//	Publishing swaps the back and middle frames, and the renderer swaps the
+//	front and middle frames when a new one was published, each with one
+//	atomic exchange.  Neither side ever waits for the other, and the frame
+//	being drawn is never written to.
+//	A frame holds a copy of the cells of the viewport (see viewport.h), or if
+//	there are more of them than the pane has pixels, the image they are
+//	reduced to (see gridReduction.h).  The frames are allocated for the
+//	largest image, and a frame only uses its first imageRows x imageCols cells.
+//	Every row of a frame also records the last generation its cells changed
+//	at, so the renderer only uploads the rows that changed since the frame
+//	it drew before.
+//-----------------------------------------------------------------------------
+
+typedef struct DisplayFrame
+{
+	uint8_t*		cells;
+	uint8_t**		rows;			//	2D scaffold on top of cells, like currentGrid2D
+	unsigned long	generation;		//	generation the frame shows
+	Viewport		view;			//	part of the grid it shows
+	unsigned long*	rowChangedAt;	//	generation each row of the image last changed at
+	unsigned int	imageRows, imageCols;
+	bool			reduced;		//	the cells of view were reduced to the image
+	ReductionMode	mode;			//	how, if they were
+} DisplayFrame;
+
+void initializeDisplayFrames(unsigned int numRows, unsigned int numCols);
+void freeDisplayFrames(void);
+
+//	compute side
+bool frameWanted(void);
+bool newFrameAvailable(void);
+DisplayFrame* getBackFrame(void);
+void publishFrame(unsigned long generation);
+
+//	renderer side
+const DisplayFrame* getLatestFrame(void);
+
+
+#endif // DISPLAY_FRAMES_H
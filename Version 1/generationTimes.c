@@ -0,0 +1,120 @@
+//
+//  generationTimes.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+//
+#include "generationTimes.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+//	The array starts with at most INITIAL_CAPACITY times, whatever the number
+//	of generations asked for (a long run may never reach it), and doubles
+//	when full.  If memory runs out, the times of the later generations are
+//	not recorded.
+#define INITIAL_CAPACITY	1024
+
+static double* times = NULL;
+static unsigned long numTimes = 0, capacity = 0;
+static int outOfMemory = 0;
+
+//	the percentiles are read from the sorted times
+static int sorted = 0;
+
+
+//	expectedCount is only a hint (0 if unknown):  the array grows as needed
+void initializeGenerationTimes(unsigned long expectedCount)
+{
+	capacity = (expectedCount > 0 && expectedCount < INITIAL_CAPACITY) ? expectedCount : INITIAL_CAPACITY;
+	times = (double*) malloc(capacity*sizeof(double));
+	numTimes = 0;
+	sorted = 0;
+	outOfMemory = (times == NULL);
+	if (outOfMemory)
+	{
+		printf("\nOut of memory:  the generation times are not recorded.\n");
+		capacity = 0;
+	}
+}
+
+void freeGenerationTimes(void)
+{
+	free(times);
+	times = NULL;
+	numTimes = capacity = 0;
+}
+
+void recordGenerationTime(double seconds)
+{
+	if (outOfMemory)
+		return;
+
+	if (numTimes == capacity)
+	{
+		double* newTimes = (double*) realloc(times, 2*capacity*sizeof(double));
+		if (newTimes == NULL)
+		{
+			printf("\nOut of memory:  the generation times after the first %lu are not recorded.\n", numTimes);
+			outOfMemory = 1;
+			return;
+		}
+		times = newTimes;
+		capacity *= 2;
+	}
+	times[numTimes++] = seconds;
+	sorted = 0;
+}
+
+unsigned long getNumGenerationTimes(void)
+{
+	return numTimes;
+}
+
+double meanGenerationTime(void)
+{
+	double sum = 0.0;
+
+	if (numTimes == 0)
+		return 0.0;
+	for (unsigned long g=0; g<numTimes; g++)
+		sum += times[g];
+	return sum / numTimes;
+}
+
+static int compareTimes(const void* a, const void* b)
+{
+	double ta = *(const double*) a, tb = *(const double*) b;
+	return (ta > tb) - (ta < tb);
+}
+
+/*
+ * Smallest recorded time such that at least percent % of the times are no
+ * longer (nearest rank), 0 if nothing was recorded
+ */
+double generationTimePercentile(double percent)
+{
+	if (numTimes == 0)
+		return 0.0;
+
+	if (!sorted)
+	{
+		qsort(times, numTimes, sizeof(double), compareTimes);
+		sorted = 1;
+	}
+
+	double exactRank = percent / 100.0 * numTimes;
+	unsigned long rank = (unsigned long) exactRank;
+	if (rank < exactRank)
+		rank++;
+	if (rank < 1)
+		rank = 1;
+	if (rank > numTimes)
+		rank = numTimes;
+	return times[rank - 1];
+}
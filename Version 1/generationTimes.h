@@ -0,0 +1,28 @@
+//
+//  generationTimes.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef GENERATION_TIMES_H
+#define GENERATION_TIMES_H
+
+//-----------------------------------------------------------------------------
+//	Wall clock time of every generation of a headless run, from the end of
+//	one to the end of the next (barrier included), for the latency
+//	percentiles of its report.  The times are only ever recorded by the
+//	thread that ends a generation, while the others wait at the barrier.
+//-----------------------------------------------------------------------------
+
+void initializeGenerationTimes(unsigned long expectedCount);
+void freeGenerationTimes(void);
+
+void recordGenerationTime(double seconds);
+
+unsigned long getNumGenerationTimes(void);
+double meanGenerationTime(void);
+double generationTimePercentile(double percent);
+
+
+#endif // GENERATION_TIMES_H
@@ -8,6 +8,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdatomic.h>
 //
 #include "gl_frontEnd.h"
 
@@ -20,19 +21,26 @@ void myResize(int w, int h);
 void displayTextualInfo(const char* infoStr, int x, int y, int isLarge);
 void myMouse(int b, int s, int x, int y);
 void myGridPaneMouse(int b, int s, int x, int y);
+void myGridPaneMotion(int x, int y);
 void myStatePaneMouse(int b, int s, int x, int y);
 void myKeyboard(unsigned char c, int x, int y);
 void myMenuHandler(int value);
 void mySubmenuHandler(int colorIndex);
 void myTimer(int val);
 void* threadFunc(void*);
+int initializeGridTexture(unsigned int numRows, unsigned int numCols);
+int drawGridTexture(const void* const* rows, unsigned int numRows, unsigned int numCols,
+					size_t cellSize, GLenum format, GLenum type, const uint8_t* changedRows);
+void uploadTextureRows(const void* const* rows, unsigned int startRow, unsigned int endRow,
+					   unsigned int numCols, size_t cellSize, GLenum format, GLenum type);
+void paneToGrid(int x, int y, double* row, double* col);
+void drawGridQuads(uint8_t** grid, unsigned int numRows, unsigned int numCols);
 
 //---------------------------------------------------------------------------
 //  Defined in main.c
 //---------------------------------------------------------------------------
 
 extern const int MAX_NUM_THREADS;
-extern unsigned int rule;
 extern unsigned int colorMode;
 extern int sleepTimer;
 
@@ -101,32 +109,55 @@ int	gMainWindow,
 
 int drawGridLines = 0;
 
+//	Set by the pipe commands, which may change what the panes show:  the
+//	timer only redraws the window when this is set or the grid changed (see
+//	gridChanged).  Mouse and keyboard events post a redisplay themselves.
+atomic_int redrawRequested = 1;
+
+//	The timer ticks targetFps times per second (--fps, or "fps" through the
+//	pipe), whatever the rate of the compute threads.  nextFrameTime is when
+//	the next tick is due (see wallClockTime), and statsTime when the frame
+//	stats (see frameStats.h) were last drawn.
+double targetFps = DEFAULT_TARGET_FPS;
+double nextFrameTime = 0.0, statsTime = 0.0;
+
+//	Mouse wheel "buttons" of freeglut, and how much one notch zooms in or out
+#ifndef GLUT_WHEEL_UP
+	#define GLUT_WHEEL_UP	3
+	#define GLUT_WHEEL_DOWN	4
+#endif
+#define ZOOM_STEP	1.25
+
+//	last position of the mouse while the viewport is dragged with the left button
+int isDragging = 0;
+int dragX, dragY;
+
+//	The grid is drawn as a single texture, one texel per cell (or per pixel of
+//	the image of a grid larger than the pane), on one quad.  The cell states
+//	are uploaded as color indices, one byte per cell, and GL turns them into
+//	the colors of cellColor through its pixel maps (whose size must be a
+//	power of 2).  gridTextureRows/Cols are 0 until the texture is created,
+//	and the texture is 0 if the grid doesn't fit in one.
+#define PALETTE_SIZE	8
+
+GLuint gridTexture = 0;
+unsigned int gridTextureRows = 0, gridTextureCols = 0;
+
 //---------------------------------------------------------------------------
 //	Drawing functions
 //---------------------------------------------------------------------------
 
 
 //	This is the function that does the actual grid drawing
-void drawGrid(int**grid, unsigned int numRows, unsigned int numCols)
+void drawGrid(uint8_t** grid, unsigned int numRows, unsigned int numCols, const uint8_t* changedRows)
 {
 	const float	DH = (1.f * GRID_PANE_WIDTH) / numCols,
 				DV = (1.f * GRID_PANE_HEIGHT) / numRows;
-	
-	//	Display the grid as a series of quad strips
-	for (unsigned int i=0; i<numRows; i++)
-	{
-		glBegin(GL_QUAD_STRIP);
-			for (unsigned int j=0; j<numCols; j++)
-			{
-				
-				glColor4fv(cellColor[grid[i][j]]);
 
-				glVertex2f(j*DH, i*DV);
-				glVertex2f(j*DH, (i+1)*DV);
-				glVertex2f((j+1)*DH, i*DV);
-				glVertex2f((j+1)*DH, (i+1)*DV);
-			}
-		glEnd();
+	if (drawGridTexture((const void* const*) grid, numRows, numCols, sizeof(uint8_t),
+						GL_COLOR_INDEX, GL_UNSIGNED_BYTE, changedRows) != 0)
+	{
+		drawGridQuads(grid, numRows, numCols);
 	}
 
 	if (drawGridLines)
@@ -150,6 +181,176 @@ void drawGrid(int**grid, unsigned int numRows, unsigned int numCols)
 	}
 }
 
+/*
+ * Draws an image made from a grid larger than the pane (see gridReduction.h):
+ * the oldest state of each block of cells, or with isDensity set, the
+ * fraction of its cells that are alive, in shades of grey
+ */
+void drawReducedGrid(uint8_t** image, unsigned int imageRows, unsigned int imageCols, int isDensity,
+					 const uint8_t* changedRows)
+{
+	drawGridTexture((const void* const*) image, imageRows, imageCols, sizeof(uint8_t),
+					isDensity ? GL_LUMINANCE : GL_COLOR_INDEX, GL_UNSIGNED_BYTE, changedRows);
+}
+
+/*
+ * Uploads the numRows x numCols image whose row i starts at rows[i] (cells of
+ * cellSize bytes, in the given GL format and type) to the texture, and draws
+ * it over the whole pane.  Returns -1 if the image doesn't fit in a texture.
+ * If changedRows isn't NULL, only the rows i with changedRows[i] set differ
+ * from what the texture holds, and only they are uploaded.
+ */
+int drawGridTexture(const void* const* rows, unsigned int numRows, unsigned int numCols,
+					size_t cellSize, GLenum format, GLenum type, const uint8_t* changedRows)
+{
+	//	a new texture holds nothing yet
+	if (gridTextureRows != numRows || gridTextureCols != numCols)
+	{
+		initializeGridTexture(numRows, numCols);
+		changedRows = NULL;
+	}
+	if (gridTexture == 0)
+		return -1;
+
+	//	Upload the cells (color indices go through the pixel maps, which apply
+	//	the palette), one run of changed rows at a time
+	glBindTexture(GL_TEXTURE_2D, gridTexture);
+	if (changedRows == NULL)
+		uploadTextureRows(rows, 0, numRows, numCols, cellSize, format, type);
+	else
+	{
+		unsigned int i = 0;
+		while (i < numRows)
+		{
+			unsigned int startRow = i;
+			while (i < numRows && changedRows[i])
+				i++;
+			if (i > startRow)
+				uploadTextureRows(rows, startRow, i, numCols, cellSize, format, type);
+			while (i < numRows && !changedRows[i])
+				i++;
+		}
+	}
+
+	//	Row i of the texture covers the same part of the pane as before
+	glEnable(GL_TEXTURE_2D);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+	glBegin(GL_QUADS);
+		glTexCoord2f(0.f, 0.f);	glVertex2f(0.f, 0.f);
+		glTexCoord2f(1.f, 0.f);	glVertex2f(GRID_PANE_WIDTH, 0.f);
+		glTexCoord2f(1.f, 1.f);	glVertex2f(GRID_PANE_WIDTH, GRID_PANE_HEIGHT);
+		glTexCoord2f(0.f, 1.f);	glVertex2f(0.f, GRID_PANE_HEIGHT);
+	glEnd();
+	glDisable(GL_TEXTURE_2D);
+
+	return 0;
+}
+
+/*
+ * Uploads the rows [startRow, endRow) of the image to the bound texture.
+ * Rows evenly spaced in memory (the usual case) go in a single call.
+ */
+void uploadTextureRows(const void* const* rows, unsigned int startRow, unsigned int endRow,
+					   unsigned int numCols, size_t cellSize, GLenum format, GLenum type)
+{
+	const char* firstRow = (const char*) rows[startRow];
+	size_t rowStride = (endRow - startRow > 1) ? (size_t) ((const char*) rows[startRow+1] - firstRow) / cellSize
+											   : numCols;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if ((const char*) rows[endRow-1] == firstRow + (endRow-1 - startRow)*rowStride*cellSize && rowStride >= numCols)
+	{
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint) rowStride);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, startRow, numCols, endRow - startRow, format, type, firstRow);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+	else
+	{
+		for (unsigned int i=startRow; i<endRow; i++)
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, i, numCols, 1, format, type, rows[i]);
+	}
+}
+
+/*
+ * Creates the texture of the grid, and the pixel maps that turn the cell
+ * states into colors.  Called from drawGridTexture, in the context of the grid
+ * pane.
+ * Returns -1 (and leaves gridTexture at 0) if the grid is too large for a
+ * texture, in which case it is drawn one quad per cell.
+ */
+int initializeGridTexture(unsigned int numRows, unsigned int numCols)
+{
+	GLint maxSize;
+	GLfloat red[PALETTE_SIZE], green[PALETTE_SIZE], blue[PALETTE_SIZE], alpha[PALETTE_SIZE];
+
+	gridTextureRows = numRows;
+	gridTextureCols = numCols;
+	if (gridTexture != 0)
+	{
+		glDeleteTextures(1, &gridTexture);
+		gridTexture = 0;
+	}
+
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	if (numRows > (unsigned int) maxSize || numCols > (unsigned int) maxSize)
+		return -1;
+
+	//	states past the last color (there should be none) are drawn like it
+	for (int c=0; c<PALETTE_SIZE; c++)
+	{
+		int k = (c < NB_COLORS) ? c : NB_COLORS-1;
+		red[c] = cellColor[k][0];
+		green[c] = cellColor[k][1];
+		blue[c] = cellColor[k][2];
+		alpha[c] = cellColor[k][3];
+	}
+	glPixelMapfv(GL_PIXEL_MAP_I_TO_R, PALETTE_SIZE, red);
+	glPixelMapfv(GL_PIXEL_MAP_I_TO_G, PALETTE_SIZE, green);
+	glPixelMapfv(GL_PIXEL_MAP_I_TO_B, PALETTE_SIZE, blue);
+	glPixelMapfv(GL_PIXEL_MAP_I_TO_A, PALETTE_SIZE, alpha);
+
+	//	one texel per cell:  no filtering, and no power of 2 size required
+	glGenTextures(1, &gridTexture);
+	glBindTexture(GL_TEXTURE_2D, gridTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, numCols, numRows, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+
+	if (glGetError() != GL_NO_ERROR)
+	{
+		glDeleteTextures(1, &gridTexture);
+		gridTexture = 0;
+		return -1;
+	}
+	return 0;
+}
+
+//	The grid as a series of quad strips, one quad per cell (for grids that
+//	don't fit in a texture)
+void drawGridQuads(uint8_t** grid, unsigned int numRows, unsigned int numCols)
+{
+	const float	DH = (1.f * GRID_PANE_WIDTH) / numCols,
+				DV = (1.f * GRID_PANE_HEIGHT) / numRows;
+	
+	for (unsigned int i=0; i<numRows; i++)
+	{
+		glBegin(GL_QUAD_STRIP);
+			for (unsigned int j=0; j<numCols; j++)
+			{
+				
+				glColor4fv(cellColor[grid[i][j]]);
+
+				glVertex2f(j*DH, i*DV);
+				glVertex2f(j*DH, (i+1)*DV);
+				glVertex2f((j+1)*DH, i*DV);
+				glVertex2f((j+1)*DH, (i+1)*DV);
+			}
+		glEnd();
+	}
+}
+
 
 
 
@@ -237,32 +438,21 @@ void drawState(unsigned int numLiveThreads, int maxThreadCount)
 /*
  * This function draws the current role to the window
  */
-void drawRule(int currentRule)
+void drawRule(const RuleTable* currentRule)
 {
 	const int H_PAD = STATE_PANE_WIDTH / 16;
 	const int TOP_LEVEL_TXT_Y = 8*STATE_PANE_HEIGHT / 11;
 
 	char infoStr[256];
 
-	if(currentRule == 1)								
-	{
-		sprintf(infoStr, "Mode(%d): Game of Life", currentRule);
-	}
-	else if(currentRule == 2)
-	{
-		sprintf(infoStr, "Mode(%d): Coral", currentRule);
-	}
-	else if(currentRule == 3)
+	//	the presets are displayed by name, any other rule by its B/S string
+	if(currentRule->number != 0)
 	{
-		sprintf(infoStr, "Mode(%d): Amoeba", currentRule);
-	}
-	else if(currentRule == 4)
-	{
-		sprintf(infoStr, "Mode(%d): Maze", currentRule);
+		sprintf(infoStr, "Mode(%d): %s", currentRule->number, presetRuleName(currentRule->number));
 	}
 	else
 	{
-		sprintf(infoStr, "Mode(_): Unknown");
+		sprintf(infoStr, "Mode: %s", currentRule->str);
 	}
 
 	displayTextualInfo(infoStr, H_PAD, TOP_LEVEL_TXT_Y, 1);
@@ -283,6 +473,71 @@ void drawSleepTimer(void)
 	displayTextualInfo(infoStr, H_PAD, TOP_LEVEL_TXT_Y, 1);
 }
 
+/*
+ * This function draws the behavior at the border of the frame
+ */
+void drawFrameBehavior(const char* frameName)
+{
+	const int H_PAD = STATE_PANE_WIDTH / 16;
+	const int TOP_LEVEL_TXT_Y = 32*STATE_PANE_HEIGHT / 55;
+
+	char infoStr[256];
+
+	sprintf(infoStr, "Frame: %s", frameName);
+
+	displayTextualInfo(infoStr, H_PAD, TOP_LEVEL_TXT_Y, 1);
+}
+
+/*
+ * This function draws how the grid is rendered:  cell by cell, or reduced to
+ * the size of the pane (see gridReduction.h), and which part of it is shown
+ */
+void drawRenderMode(const char* modeName, const Viewport* view, double zoom)
+{
+	const int H_PAD = STATE_PANE_WIDTH / 16;
+	const int TOP_LEVEL_TXT_Y = 28*STATE_PANE_HEIGHT / 55;
+	const int VIEW_TXT_Y = 25*STATE_PANE_HEIGHT / 55;
+
+	char infoStr[256];
+
+	sprintf(infoStr, "Render: %s", modeName);
+	displayTextualInfo(infoStr, H_PAD, TOP_LEVEL_TXT_Y, 1);
+
+	sprintf(infoStr, "View: rows %u-%u, cols %u-%u (x%.2f)", view->firstRow, view->firstRow + view->numRows - 1,
+			view->firstCol, view->firstCol + view->numCols - 1, zoom);
+	displayTextualInfo(infoStr, H_PAD, VIEW_TXT_Y, 0);
+}
+
+/*
+ * This function draws the frame rate of the display against its target, the
+ * rate of the compute threads, and how long drawing a frame takes (see
+ * frameStats.h)
+ */
+void drawFrameStats(void)
+{
+	const int H_PAD = STATE_PANE_WIDTH / 16;
+	const int TOP_LEVEL_TXT_Y = 21*STATE_PANE_HEIGHT / 55;
+	const int COMPUTE_TXT_Y = 18*STATE_PANE_HEIGHT / 55;
+	const int FRAME_TIME_TXT_Y = 15*STATE_PANE_HEIGHT / 55;
+
+	char infoStr[256];
+	FrameStats stats;
+
+	statsTime = wallClockTime();
+	getFrameStats(statsTime, generationsComputed(), &stats);
+
+	sprintf(infoStr, "Display: %.1f/%.0f fps", stats.renderFps, targetFps);
+	displayTextualInfo(infoStr, H_PAD, TOP_LEVEL_TXT_Y, 1);
+
+	sprintf(infoStr, "Compute: %.1f generations/s", stats.generationsPerSecond);
+	displayTextualInfo(infoStr, H_PAD, COMPUTE_TXT_Y, 0);
+
+	//	frame times near 1000/targetFps ms mean the display can't keep up
+	sprintf(infoStr, "Frame time: p50 %.1f, p95 %.1f, p99 %.1f ms",
+			1000*stats.frameTimeP50, 1000*stats.frameTimeP95, 1000*stats.frameTimeP99);
+	displayTextualInfo(infoStr, H_PAD, FRAME_TIME_TXT_Y, 0);
+}
+
 /*
  * This function draws the title of the program
  */
@@ -319,6 +574,8 @@ void myResize(int w, int h)
 
 void myDisplay(void)
 {
+	double startTime = wallClockTime();
+
     glutSetWindow(gMainWindow);
 
     glMatrixMode(GL_MODELVIEW);
@@ -329,6 +586,8 @@ void myDisplay(void)
 	stateDisplayFunc();
 	
     glutSetWindow(gMainWindow);	
+
+	recordFrame(startTime, wallClockTime() - startTime);
 }
 
 //	This function is called when a mouse event occurs just in the tiny
@@ -340,20 +599,35 @@ void myMouse(int button, int state, int x, int y)
 	glutPostRedisplay();
 }
 
-//	This function is called when a mouse event occurs in the grid pane
+//	This function is called when a mouse event occurs in the grid pane:
+//	the wheel zooms in and out around the cell under the mouse, and the left
+//	button drags the viewport
 //
 void myGridPaneMouse(int button, int state, int x, int y)
 {
+	double row, col;
+
 	switch (button)
 	{
 		case GLUT_LEFT_BUTTON:
 			if (state == GLUT_DOWN)
 			{
-				//	do something
+				isDragging = 1;
+				dragX = x;
+				dragY = y;
 			}
 			else if (state == GLUT_UP)
 			{
-				//	exit(0);
+				isDragging = 0;
+			}
+			break;
+
+		case GLUT_WHEEL_UP:
+		case GLUT_WHEEL_DOWN:
+			if (state == GLUT_DOWN)
+			{
+				paneToGrid(x, y, &row, &col);
+				zoomViewport(button == GLUT_WHEEL_UP ? ZOOM_STEP : 1/ZOOM_STEP, row, col);
 			}
 			break;
 			
@@ -365,6 +639,38 @@ void myGridPaneMouse(int button, int state, int x, int y)
 	glutPostRedisplay();
 }
 
+//	This function is called when the mouse moves in the grid pane with a
+//	button down:  the grid follows the mouse while it is dragged
+//
+void myGridPaneMotion(int x, int y)
+{
+	if (isDragging)
+	{
+		Viewport view;
+		getViewport(&view);
+
+		//	grid rows go up the pane, and window y down
+		panViewport((y - dragY) * (double) view.numRows / GRID_PANE_HEIGHT,
+					(dragX - x) * (double) view.numCols / GRID_PANE_WIDTH);
+		dragX = x;
+		dragY = y;
+
+		glutSetWindow(gMainWindow);
+		glutPostRedisplay();
+	}
+}
+
+//	Fractional row and column of the grid at the pixel (x, y) of the grid
+//	pane (window coordinates, y going down)
+void paneToGrid(int x, int y, double* row, double* col)
+{
+	Viewport view;
+	getViewport(&view);
+
+	*row = view.firstRow + (GRID_PANE_HEIGHT - y) * (double) view.numRows / GRID_PANE_HEIGHT;
+	*col = view.firstCol + x * (double) view.numCols / GRID_PANE_WIDTH;
+}
+
 //	This function is called when a mouse event occurs in the state pane
 void myStatePaneMouse(int button, int state, int x, int y)
 {
@@ -405,7 +711,7 @@ void myKeyboard(unsigned char c, int x, int y)
 
 		//	spacebar --> resets the grid
 		case ' ':
-			resetGrid();
+			requestReset();
 			break;
 
 		//	'+' --> increase simulation speed
@@ -421,25 +727,19 @@ void myKeyboard(unsigned char c, int x, int y)
 			sleepTimer += 5000;
 			break;
 
-		//	'1' --> apply Rule 1 (Game of Life: B23/S3)
+		//	'1' --> apply Rule 1 (Game of Life: B3/S23)
+		//	'2' --> apply Rule 2 (Coral: B3/S45678)
+		//	'3' --> apply Rule 3 (Amoeba: B357/S1358)
+		//	'4' --> apply Rule 4 (Maze: B3/S12345)
 		case '1':
-			rule = GAME_OF_LIFE_RULE;
-			break;
-
-		//	'2' --> apply Rule 2 (Coral: B3_S45678)
 		case '2':
-			rule = CORAL_GROWTH_RULE;
-			break;
-
-		//	'3' --> apply Rule 3 (Amoeba: B357/S1358)
 		case '3':
-			rule = AMOEBA_RULE;
-			break;
-
-		//	'4' --> apply Rule 4 (Maze: B3/S12345)
 		case '4':
-			rule = MAZE_RULE;
+		{
+			char ruleStr[2] = {(char) c, '\0'};
+			setRule(ruleStr);
 			break;
+		}
 
 		//	'c' --> toggles on/off color mode
 		//	'b' --> toggles off/on color mode
@@ -452,6 +752,18 @@ void myKeyboard(unsigned char c, int x, int y)
 		case 'l':
 			drawGridLines = !drawGridLines;
 			break;
+
+		//	'd' --> switches between the oldest state and the density of
+		//			live cells, for a grid larger than the pane
+		case 'd':
+			cycleReductionMode();
+			break;
+
+		//	'v' --> shows the whole grid again (the mouse wheel zooms in
+		//			and out, and dragging moves the viewport)
+		case 'v':
+			resetViewport();
+			break;
 		default:
 			ok = 1;
 			break;
@@ -467,27 +779,89 @@ void myKeyboard(unsigned char c, int x, int y)
 
 void commandHandler(char* cmd)
 {
+	atomic_store(&redrawRequested, 1);
+
 	if(strncmp("end", cmd, 3) == 0)
 	{
 		exit(0);
 	}
-	else if(strncmp("rule", cmd, 4) == 0)
+	else if(strncmp("rule ", cmd, 5) == 0)
 	{
-		if(cmd[5] == '1')
+		//	either a rule number 1-4 or any B/S rule string (e.g. "rule B36/S23")
+		if(setRule(cmd + 5) != 0)
 		{
-			rule = GAME_OF_LIFE_RULE;
+			printf("Invalid rule: %s", cmd + 5);
 		}
-		else if(cmd[5] == '2')
+	}
+	else if(strncmp("frame ", cmd, 6) == 0)
+	{
+		//	dead, wrap, clipped or random (e.g. "frame wrap")
+		if(setFrameBehavior(cmd + 6) != 0)
 		{
-			rule = CORAL_GROWTH_RULE;
+			printf("Invalid frame behavior: %s", cmd + 6);
 		}
-		else if(cmd[5] == '3')
+	}
+	else if(strncmp("render ", cmd, 7) == 0)
+	{
+		//	how a grid larger than the pane is drawn:  maxage or density
+		if(setReductionMode(cmd + 7) != 0)
 		{
-			rule = AMOEBA_RULE;
+			printf("Invalid render mode: %s", cmd + 7);
 		}
-		else if(cmd[5] == '4')
+	}
+	else if(strncmp("fps ", cmd, 4) == 0)
+	{
+		//	target rate of the display, e.g. "fps 30"
+		double fps;
+		if(sscanf(cmd + 4, "%lf", &fps) != 1 || setTargetFps(fps) != 0)
 		{
-			rule = MAZE_RULE;
+			printf("Invalid frame rate: %s", cmd + 4);
+		}
+	}
+	else if(strncmp("zoom ", cmd, 5) == 0)
+	{
+		//	zooms in (out if less than 1) around the center of the viewport, e.g. "zoom 4"
+		double factor;
+		Viewport view;
+		getViewport(&view);
+		if(sscanf(cmd + 5, "%lf", &factor) == 1 && factor > 0.0)
+		{
+			zoomViewport(factor, view.firstRow + view.numRows/2.0, view.firstCol + view.numCols/2.0);
+		}
+		else
+		{
+			printf("Invalid zoom: %s", cmd + 5);
+		}
+	}
+	else if(strncmp("pan ", cmd, 4) == 0)
+	{
+		//	moves the viewport by some rows and columns, e.g. "pan -100 250"
+		double numRows, numCols;
+		if(sscanf(cmd + 4, "%lf %lf", &numRows, &numCols) == 2)
+		{
+			panViewport(numRows, numCols);
+		}
+		else
+		{
+			printf("Invalid pan: %s", cmd + 4);
+		}
+	}
+	else if(strncmp("view ", cmd, 5) == 0)
+	{
+		//	"view reset" shows the whole grid, and "view row col zoom" the
+		//	given zoom, centered on a cell, e.g. "view 5000 5000 100"
+		double row, col, zoom;
+		if(strncmp("reset", cmd + 5, 5) == 0)
+		{
+			resetViewport();
+		}
+		else if(sscanf(cmd + 5, "%lf %lf %lf", &row, &col, &zoom) == 3 && zoom > 0.0)
+		{
+			centerViewport(row, col, zoom);
+		}
+		else
+		{
+			printf("Invalid view: %s", cmd + 5);
 		}
 	}
 	else if(strncmp("color on", cmd, 8) == 0)
@@ -522,10 +896,33 @@ void myTimer(int value)
 	//	This call must **DEFINITELY** go away.
     //threadFunc(NULL);
 
-    myDisplay();
+	//	nothing is drawn again if nothing changed since the last time, but the
+	//	frame stats in the state pane are kept up to date
+	if (atomic_exchange(&redrawRequested, 0) || gridChanged())
+		myDisplay();
+	else if (wallClockTime() - statsTime >= FRAME_STATS_PERIOD)
+		stateDisplayFunc();
     
-	//	And finally I perform the rendering
-	glutTimerFunc(100, myTimer, 0);
+	//	And finally I perform the rendering:  the next tick is due one period
+	//	after this one was, or right away if drawing took longer than that
+	double now = wallClockTime();
+	nextFrameTime += 1.0 / targetFps;
+	if (nextFrameTime < now)
+		nextFrameTime = now;
+	glutTimerFunc((unsigned int) (1000.0*(nextFrameTime - now) + 0.5), myTimer, 0);
+}
+
+/*
+ * Sets the number of frames per second the display aims at.  Returns 0 on
+ * success, -1 if the rate is out of [1, MAX_TARGET_FPS].
+ */
+int setTargetFps(double fps)
+{
+	if (fps < 1.0 || fps > MAX_TARGET_FPS)
+		return -1;
+
+	targetFps = fps;
+	return 0;
 }
 
 void myMenuHandler(int choice)
@@ -583,6 +980,7 @@ void initializeFrontEnd(int argc, char** argv, void (*gridDisplayCB)(void),
 	glClearColor(0.f, 0.f, 0.f, 1.f);
 	glutKeyboardFunc(myKeyboard);
 	glutMouseFunc(myGridPaneMouse);
+	glutMotionFunc(myGridPaneMotion);
 	glutDisplayFunc(gridDisplayCB);
 	
 	
@@ -596,6 +994,6 @@ void initializeFrontEnd(int argc, char** argv, void (*gridDisplayCB)(void),
 	glOrtho(0.0f, STATE_PANE_WIDTH, 0.0f, STATE_PANE_HEIGHT, -1, 1);
 	glClearColor(0.f, 0.f, 0.f, 1.f);
 	glutKeyboardFunc(myKeyboard);
-	glutMouseFunc(myGridPaneMouse);
+	glutMouseFunc(myStatePaneMouse);
 	glutDisplayFunc(stateDisplayCB);
 }
@@ -0,0 +1,48 @@
+//
+//  gridReduction.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef GRID_REDUCTION_H
+#define GRID_REDUCTION_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+//	Reduction of a grid that has more cells than the grid pane has pixels to
+//	an image of at most the size of the pane:  pixel (r, c) of an image of
+//	imageRows x imageCols pixels stands for the block of cells of rows
+//	r*numRows/imageRows up to (r+1)*numRows/imageRows excluded, and likewise
+//	for the columns.  A pixel is either the oldest state of its block, which
+//	is drawn with the colors of the cells, or the fraction of live cells of
+//	the block (0-255), drawn in shades of grey.  Drawing then only depends on
+//	the size of the pane, not on the size of the grid.  Only the part of the
+//	grid in the viewport (see viewport.h) is reduced.
+//-----------------------------------------------------------------------------
+
+typedef enum ReductionMode
+{
+	REDUCE_MAX_AGE = 0,
+	REDUCE_DENSITY,
+	//
+	NB_REDUCTION_MODES
+} ReductionMode;
+
+extern const char* REDUCTION_MODE_STR[NB_REDUCTION_MODES];
+
+void reducedSize(unsigned int numRows, unsigned int numCols, unsigned int maxRows, unsigned int maxCols,
+				 unsigned int* imageRows, unsigned int* imageCols);
+
+//	first row (column) of the block of cells of image row (column) k
+static inline unsigned int blockStart(unsigned int k, unsigned int numCells, unsigned int numPixels)
+{
+	return (unsigned int) (((unsigned long long) k * numCells) / numPixels);
+}
+
+void reduceBlockRow(uint8_t* const* rows, unsigned int numBlockRows, unsigned int firstCol,
+					unsigned int numCols, uint8_t* pixels, unsigned int imageCols, ReductionMode mode);
+
+
+#endif // GRID_REDUCTION_H
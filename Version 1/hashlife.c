@@ -0,0 +1,531 @@
+//
+//  hashlife.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+//
+#include "hashlife.h"
+
+//---------------------------------------------------------------------------
+//  Custom data types
+//---------------------------------------------------------------------------
+
+//	A square of 2^level x 2^level cells.  Level 0 nodes are single cells
+//	(only two of them exist:  deadCell and aliveCell).
+typedef struct Node
+{
+	struct Node*	nw;
+	struct Node*	ne;
+	struct Node*	sw;
+	struct Node*	se;
+	//	memoized center square (level-1), 2^resultStep generations later
+	struct Node*	result;
+	//	next node in the same hash bucket, or in the free list
+	struct Node*	next;
+	uint64_t		population;
+	unsigned int	level;
+	unsigned int	resultStep;
+	unsigned int	marked;
+} Node;
+
+//---------------------------------------------------------------------------
+//  Interface constants
+//---------------------------------------------------------------------------
+
+//	Nodes are allocated by blocks of this many
+#define NODE_BLOCK_SIZE		65536
+
+//	When more nodes than this are alive after a step, unreachable nodes
+//	(and the memoized results pointing to them) are garbage collected
+#define GC_NODE_THRESHOLD	(1u << 22)
+
+//	Coordinates are int64_t, so the plane cannot be larger than this (the
+//	largest step, HASHLIFE_MAX_STEP_LOG2, follows from it)
+#define MAX_LEVEL			62
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+static Node deadCell, aliveCell;
+
+//	Hash table of all the nodes of level >= 1
+static Node** hashTable;
+static size_t hashSize, nodeCount;
+
+//	Allocated blocks of nodes and the list of nodes available for reuse
+static Node** nodeBlocks;
+static size_t numBlocks, maxBlocks, nextInBlock = NODE_BLOCK_SIZE;
+static Node* freeNodes;
+
+//	Canonical empty square of each level
+static Node* emptyNodes[MAX_LEVEL+1];
+
+//	The universe and how far it has been run
+static Node* root;
+static uint64_t generation;
+
+//	Rule the memoized results were computed with
+static unsigned int cachedBirthMask, cachedSurviveMask;
+static uint8_t newStateTable[2][9];
+
+//	Steps, imports and exports are called from different threads
+static pthread_mutex_t hashlifeLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+//---------------------------------------------------------------------------
+//	Node storage
+//---------------------------------------------------------------------------
+
+static Node* allocateNode(void)
+{
+	Node* node;
+
+	if (freeNodes != NULL)
+	{
+		node = freeNodes;
+		freeNodes = node->next;
+		return node;
+	}
+
+	if (nextInBlock == NODE_BLOCK_SIZE)
+	{
+		if (numBlocks == maxBlocks)
+		{
+			maxBlocks = (maxBlocks == 0) ? 64 : 2*maxBlocks;
+			nodeBlocks = (Node**) realloc(nodeBlocks, maxBlocks*sizeof(Node*));
+		}
+		nodeBlocks[numBlocks++] = (Node*) malloc(NODE_BLOCK_SIZE*sizeof(Node));
+		nextInBlock = 0;
+	}
+	node = nodeBlocks[numBlocks-1] + nextInBlock;
+	nextInBlock++;
+	return node;
+}
+
+static inline size_t hashChildren(const Node* nw, const Node* ne, const Node* sw, const Node* se)
+{
+	uint64_t h = (uint64_t) (uintptr_t) nw;
+	h = h*0x9E3779B97F4A7C15ull + (uint64_t) (uintptr_t) ne;
+	h = h*0x9E3779B97F4A7C15ull + (uint64_t) (uintptr_t) sw;
+	h = h*0x9E3779B97F4A7C15ull + (uint64_t) (uintptr_t) se;
+	return (size_t) (h ^ (h >> 29));
+}
+
+static void resizeHashTable(size_t newSize)
+{
+	Node** newTable = (Node**) calloc(newSize, sizeof(Node*));
+
+	for (size_t b=0; b<hashSize; b++)
+	{
+		Node* node = hashTable[b];
+		while (node != NULL)
+		{
+			Node* next = node->next;
+			size_t h = hashChildren(node->nw, node->ne, node->sw, node->se) & (newSize-1);
+			node->next = newTable[h];
+			newTable[h] = node;
+			node = next;
+		}
+	}
+	free(hashTable);
+	hashTable = newTable;
+	hashSize = newSize;
+}
+
+//	Returns the unique node with these four children, creating it if needed
+static Node* join(Node* nw, Node* ne, Node* sw, Node* se)
+{
+	size_t h = hashChildren(nw, ne, sw, se) & (hashSize-1);
+
+	for (Node* node = hashTable[h]; node != NULL; node = node->next)
+	{
+		if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se)
+			return node;
+	}
+
+	Node* node = allocateNode();
+	node->nw = nw;
+	node->ne = ne;
+	node->sw = sw;
+	node->se = se;
+	node->result = NULL;
+	node->level = nw->level + 1;
+	node->resultStep = 0;
+	node->marked = 0;
+	node->population = nw->population + ne->population + sw->population + se->population;
+	if (node->population < nw->population)		//	saturate rather than wrap around
+		node->population = UINT64_MAX;
+	node->next = hashTable[h];
+	hashTable[h] = node;
+	nodeCount++;
+
+	if (nodeCount > hashSize)
+		resizeHashTable(2*hashSize);
+
+	return node;
+}
+
+static Node* emptyNode(unsigned int level)
+{
+	if (emptyNodes[level] == NULL)
+	{
+		Node* sub = emptyNode(level-1);
+		emptyNodes[level] = join(sub, sub, sub, sub);
+	}
+	return emptyNodes[level];
+}
+
+//	Adds an empty border around a node:  same center, one level up
+static Node* expandNode(Node* node)
+{
+	Node* border = emptyNode(node->level-1);
+
+	return join(join(border, border, border, node->nw),
+				join(border, border, node->ne, border),
+				join(border, node->sw, border, border),
+				join(node->se, border, border, border));
+}
+
+
+//---------------------------------------------------------------------------
+//	Garbage collection
+//---------------------------------------------------------------------------
+
+static void markNode(Node* node)
+{
+	if (node->level == 0 || node->marked)
+		return;
+
+	node->marked = 1;
+	markNode(node->nw);
+	markNode(node->ne);
+	markNode(node->sw);
+	markNode(node->se);
+}
+
+//	Frees every node not reachable from the root (or one of the empty nodes)
+//	and forgets the results that pointed to freed nodes
+static void collectGarbage(void)
+{
+	markNode(root);
+	for (unsigned int level=1; level<=MAX_LEVEL; level++)
+	{
+		if (emptyNodes[level] != NULL)
+			markNode(emptyNodes[level]);
+	}
+
+	for (size_t b=0; b<hashSize; b++)
+	{
+		Node** link = &hashTable[b];
+		while (*link != NULL)
+		{
+			Node* node = *link;
+			if (node->marked)
+			{
+				if (node->result != NULL && node->result->level > 0 && !node->result->marked)
+					node->result = NULL;
+				link = &node->next;
+			}
+			else
+			{
+				*link = node->next;
+				node->next = freeNodes;
+				freeNodes = node;
+				nodeCount--;
+			}
+		}
+	}
+
+	for (size_t b=0; b<hashSize; b++)
+	{
+		for (Node* node = hashTable[b]; node != NULL; node = node->next)
+			node->marked = 0;
+	}
+}
+
+//	Memoized results depend on the rule:  forget them all when it changes
+static void useRule(unsigned int birthMask, unsigned int surviveMask)
+{
+	if (birthMask == cachedBirthMask && surviveMask == cachedSurviveMask)
+		return;
+
+	cachedBirthMask = birthMask;
+	cachedSurviveMask = surviveMask;
+	for (unsigned int k=0; k<=8; k++)
+	{
+		newStateTable[0][k] = (birthMask >> k) & 1;
+		newStateTable[1][k] = (surviveMask >> k) & 1;
+	}
+
+	for (size_t b=0; b<hashSize; b++)
+	{
+		for (Node* node = hashTable[b]; node != NULL; node = node->next)
+			node->result = NULL;
+	}
+}
+
+
+//---------------------------------------------------------------------------
+//	The Hashlife recursion
+//---------------------------------------------------------------------------
+
+//	Center square (level-2) of a level node, at the same time
+static inline Node* centerNode(Node* node)
+{
+	return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+//	Base case:  the center 2x2 of a 4x4 square, one generation later
+static Node* baseSuccessor(Node* node)
+{
+	int cell[4][4];
+	Node* quads[2][2] = {{node->nw, node->ne}, {node->sw, node->se}};
+
+	for (int qi=0; qi<2; qi++)
+	{
+		for (int qj=0; qj<2; qj++)
+		{
+			Node* q = quads[qi][qj];
+			cell[2*qi][2*qj] = (q->nw == &aliveCell);
+			cell[2*qi][2*qj+1] = (q->ne == &aliveCell);
+			cell[2*qi+1][2*qj] = (q->sw == &aliveCell);
+			cell[2*qi+1][2*qj+1] = (q->se == &aliveCell);
+		}
+	}
+
+	Node* out[2][2];
+	for (int i=1; i<=2; i++)
+	{
+		for (int j=1; j<=2; j++)
+		{
+			int count = cell[i-1][j-1] + cell[i-1][j] + cell[i-1][j+1] +
+						cell[i][j-1] + cell[i][j+1] +
+						cell[i+1][j-1] + cell[i+1][j] + cell[i+1][j+1];
+			out[i-1][j-1] = newStateTable[cell[i][j]][count] ? &aliveCell : &deadCell;
+		}
+	}
+
+	return join(out[0][0], out[0][1], out[1][0], out[1][1]);
+}
+
+/*
+ * Returns the center square (level-1) of the node, 2^step generations later.
+ * step can be at most level-2.
+ */
+static Node* successor(Node* node, unsigned int step)
+{
+	if (node->result != NULL && node->resultStep == step)
+		return node->result;
+
+	//	Nothing is ever born from nothing (no B0 rules)
+	if (node == emptyNodes[node->level])
+		return emptyNode(node->level-1);
+
+	Node* result;
+	if (node->level == 2)
+	{
+		result = baseSuccessor(node);
+	}
+	else
+	{
+		Node *a = node->nw, *b = node->ne, *c = node->sw, *d = node->se;
+
+		//	The nine overlapping level-1 squares
+		Node* n[3][3] = {
+			{a,								join(a->ne, b->nw, a->se, b->sw),	b},
+			{join(a->sw, a->se, c->nw, c->ne),	join(a->se, b->sw, c->ne, d->nw),	join(b->sw, b->se, d->nw, d->ne)},
+			{c,								join(c->ne, d->nw, c->se, d->sw),	d}
+		};
+
+		//	Full speed: the first half of the time is spent here, the second
+		//	half below.  Slower:  only the last part moves forward in time.
+		unsigned int innerStep = (step == node->level-2) ? step-1 : step;
+		Node* r[3][3];
+		for (int i=0; i<3; i++)
+		{
+			for (int j=0; j<3; j++)
+			{
+				if (step == node->level-2)
+					r[i][j] = successor(n[i][j], step-1);
+				else
+					r[i][j] = centerNode(n[i][j]);
+			}
+		}
+
+		result = join(successor(join(r[0][0], r[0][1], r[1][0], r[1][1]), innerStep),
+					  successor(join(r[0][1], r[0][2], r[1][1], r[1][2]), innerStep),
+					  successor(join(r[1][0], r[1][1], r[2][0], r[2][1]), innerStep),
+					  successor(join(r[1][1], r[1][2], r[2][1], r[2][2]), innerStep));
+	}
+
+	node->result = result;
+	node->resultStep = step;
+	return result;
+}
+
+//	True if all the live cells of the root are in its center square
+static int borderIsEmpty(Node* node)
+{
+	return node->nw->population == node->nw->se->population &&
+		   node->ne->population == node->ne->sw->population &&
+		   node->sw->population == node->sw->ne->population &&
+		   node->se->population == node->se->nw->population;
+}
+
+
+//---------------------------------------------------------------------------
+//	Conversion from/to the flat grid
+//---------------------------------------------------------------------------
+
+static Node* buildNode(uint8_t** grid, int64_t numRows, int64_t numCols,
+					   unsigned int level, int64_t x0, int64_t y0)
+{
+	int64_t size = (int64_t) 1 << level;
+
+	//	squares that don't intersect the grid are empty
+	if (x0 >= numCols || y0 >= numRows || x0 + size <= 0 || y0 + size <= 0)
+		return emptyNode(level);
+
+	if (level == 0)
+		return grid[y0][x0] != 0 ? &aliveCell : &deadCell;
+
+	int64_t half = size / 2;
+	return join(buildNode(grid, numRows, numCols, level-1, x0, y0),
+				buildNode(grid, numRows, numCols, level-1, x0 + half, y0),
+				buildNode(grid, numRows, numCols, level-1, x0, y0 + half),
+				buildNode(grid, numRows, numCols, level-1, x0 + half, y0 + half));
+}
+
+static void exportNode(Node* node, uint8_t** grid, int64_t numRows, int64_t numCols,
+					   int64_t x0, int64_t y0)
+{
+	int64_t size = (int64_t) 1 << node->level;
+
+	if (node->population == 0 ||
+		x0 >= numCols || y0 >= numRows || x0 + size <= 0 || y0 + size <= 0)
+		return;
+
+	if (node->level == 0)
+	{
+		grid[y0][x0] = 1;
+		return;
+	}
+
+	int64_t half = size / 2;
+	exportNode(node->nw, grid, numRows, numCols, x0, y0);
+	exportNode(node->ne, grid, numRows, numCols, x0 + half, y0);
+	exportNode(node->sw, grid, numRows, numCols, x0, y0 + half);
+	exportNode(node->se, grid, numRows, numCols, x0 + half, y0 + half);
+}
+
+
+//---------------------------------------------------------------------------
+//	Public functions
+//---------------------------------------------------------------------------
+
+void initializeHashlife(void)
+{
+	deadCell.level = aliveCell.level = 0;
+	deadCell.population = 0;
+	aliveCell.population = 1;
+	emptyNodes[0] = &deadCell;
+
+	hashSize = 1 << 16;
+	hashTable = (Node**) calloc(hashSize, sizeof(Node*));
+
+	//	impossible masks, so that the first step builds the rule table
+	cachedBirthMask = cachedSurviveMask = ~0u;
+
+	root = emptyNode(3);
+	generation = 0;
+}
+
+void freeHashlife(void)
+{
+	for (size_t b=0; b<numBlocks; b++)
+		free(nodeBlocks[b]);
+	free(nodeBlocks);
+	free(hashTable);
+}
+
+/*
+ * Replaces the universe with the content of the grid (0 = dead, else alive)
+ */
+void hashlifeImport(uint8_t** grid, unsigned int numRows, unsigned int numCols)
+{
+	pthread_mutex_lock(&hashlifeLock);
+
+	//	Large enough that the grid fits in the center square of the root
+	unsigned int level = 3;
+	while (((int64_t) 1 << level) < 2*(int64_t) (numRows > numCols ? numRows : numCols))
+		level++;
+
+	//	Plane coordinates of the root's corner, relative to the grid's corner
+	int64_t corner = -((int64_t) 1 << (level-1));
+	root = buildNode(grid, numRows, numCols, level,
+					 corner + numCols/2, corner + numRows/2);
+	generation = 0;
+
+	collectGarbage();
+
+	pthread_mutex_unlock(&hashlifeLock);
+}
+
+/*
+ * Copies the window of the plane that corresponds to the grid into the grid
+ */
+void hashlifeExport(uint8_t** grid, unsigned int numRows, unsigned int numCols)
+{
+	pthread_mutex_lock(&hashlifeLock);
+
+	for (unsigned int i=0; i<numRows; i++)
+		memset(grid[i], 0, numCols);
+
+	int64_t corner = -((int64_t) 1 << (root->level-1));
+	exportNode(root, grid, numRows, numCols, corner + numCols/2, corner + numRows/2);
+
+	pthread_mutex_unlock(&hashlifeLock);
+}
+
+/*
+ * Advances the universe by 2^stepLog2 generations (stepLog2 at most
+ * HASHLIFE_MAX_STEP_LOG2)
+ */
+void hashlifeStep(unsigned int stepLog2, unsigned int birthMask, unsigned int surviveMask)
+{
+	pthread_mutex_lock(&hashlifeLock);
+
+	useRule(birthMask, surviveMask);
+
+	//	Grow the root until the pattern cannot reach its border during the
+	//	step:  everything alive must be in the center square and the step
+	//	must not exceed a quarter of the root's size
+	while (root->level < MAX_LEVEL-1 && (root->level < stepLog2+2 || !borderIsEmpty(root)))
+		root = expandNode(root);
+
+	//	One more level of empty border, so that the successor (the center of
+	//	the expanded root) covers exactly the same square as the old root
+	root = successor(expandNode(root), stepLog2);
+	generation += (uint64_t) 1 << stepLog2;
+
+	if (nodeCount > GC_NODE_THRESHOLD)
+		collectGarbage();
+
+	pthread_mutex_unlock(&hashlifeLock);
+}
+
+uint64_t hashlifeGeneration(void)
+{
+	return generation;
+}
+
+uint64_t hashlifePopulation(void)
+{
+	return root->population;
+}
@@ -0,0 +1,42 @@
+//
+//  hashlife.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+//	Hashlife engine.  The pattern lives on an unbounded plane stored as a
+//	quadtree whose nodes are hash-consed (two identical squares are always
+//	the same node), and the future of every node is memoized, so repeated
+//	and periodic structures are only ever computed once.  One call to
+//	hashlifeStep advances the whole pattern by 2^k generations.
+//
+//	The flat grid of the front end is a window on that plane:  grid cell
+//	(i, j) is the plane cell (x, y) = (j - numCols/2, i - numRows/2).
+//	Only dead/alive is tracked (no color mode), and rules with B0 cannot
+//	be run on an unbounded plane.
+//-----------------------------------------------------------------------------
+
+void initializeHashlife(void);
+void freeHashlife(void);
+
+void hashlifeImport(uint8_t** grid, unsigned int numRows, unsigned int numCols);
+void hashlifeExport(uint8_t** grid, unsigned int numRows, unsigned int numCols);
+
+//	Largest step hashlifeStep can take:  the root must stay at least 4 times
+//	as large as the step, and it cannot grow past level 61 (see MAX_LEVEL)
+#define HASHLIFE_MAX_STEP_LOG2	59
+
+void hashlifeStep(unsigned int stepLog2, unsigned int birthMask, unsigned int surviveMask);
+
+uint64_t hashlifeGeneration(void);
+uint64_t hashlifePopulation(void);
+
+
+#endif // HASHLIFE_H
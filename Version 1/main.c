@@ -20,6 +20,12 @@
 |		- 'c' --> toggle color mode on/off									|
 |		- 'b' --> toggles color mode off/on									|
 |		- 'l' --> toggles on/off grid line rendering						|
+|		- 'd' --> switches between oldest state and density of live			|
+|				  cells, for a grid larger than the pane					|
+|		- 'v' --> shows the whole grid again								|
+|																			|
+|		- mouse wheel --> zoom in/out around the cell under the mouse		|
+|		- left button drag --> move the part of the grid shown				|
 |																			|
 |		- '+' --> increase simulation speed									|
 |		- '-' --> reduce simulation speed									|
@@ -29,6 +35,35 @@
 |		- '3' --> apply Rule 3 (Amoeba: B357/S1358)							|
 |		- '4' --> apply Rule 4 (Maze: B3/S12345)							|
 |																			|
+|	Build (all .c files of this directory):									|
+|																			|
+|		gcc -O2 *.c -lglut -lGL -lpthread -o cell							|
+|																			|
+|	Command line:															|
+|																			|
+|		./cell rows columns [max thread count] [options]					|
+|																			|
+|		--engine scalar|simd|bits|hashlife									|
+|								compute kernel (default: simd)				|
+|		--rule B3/S23			any B/S rule, or a rule number 1-4			|
+|		--step k				hashlife: 2^k generations per step			|
+|		--active-tiles on|off	skip tiles where nothing moves (default on)	|
+|		--frame dead|wrap|clipped|random									|
+|								behavior at the border (default: dead)		|
+|		--pin					pin each compute thread to its own CPU		|
+|		--numa-report			print where the rows of each thread live	|
+|		--generations n			run n generations without a window, print	|
+|								timings and stats, then exit (headless)		|
+|		--seconds t				same, for t seconds (the first limit		|
+|								reached ends the run)						|
+|		--report text|csv|json	format of the report of a headless run		|
+|		--color on|off			color mode at startup (default: off)		|
+|		--fps n					frames per second the display aims at		|
+|								(default: 60)								|
+|																			|
+|	Benchmark.sh (next to Interpreter.sh) runs headless benchmarks over		|
+|	grid sizes, thread counts, rules, color and frame modes, engines.		|
+|																			|
 +--------------------------------------------------------------------------*/
 
 #include <stdio.h>
@@ -39,9 +74,22 @@
 #include <string.h>
 #include <pthread.h>
 #include <stdbool.h>
-#include <semaphore.h>
+#include <stdatomic.h>
+#include <getopt.h>
 
 #include "gl_frontEnd.h"
+#include "bitGrid.h"
+#include "simdGeneration.h"
+#include "rules.h"
+#include "hashlife.h"
+#include "activeTiles.h"
+#include "generationBarrier.h"
+#include "workScheduler.h"
+#include "numaPlacement.h"
+#include "displayFrames.h"
+#include "gridReduction.h"
+#include "viewport.h"
+#include "generationTimes.h"
 
 //==================================================================================
 //	Custom data types
@@ -50,13 +98,50 @@ typedef struct ThreadInfo
 {
 	pthread_t 	threadID;
 	int 		index;
-	int 		startIndex;
-	int 		endIndex;
+	int			cpu;		//	where the thread ran when it touched its rows
+	int			node;		//	(-1 if unknown)
 	//
 	//	whatever other input or output data may be needed
 	//
 } ThreadInfo;
 
+//	The rows of a generation are handed out to the threads in blocks of this
+//	many rows (see workScheduler.h)
+#define ROWS_PER_BLOCK	16
+
+//	The compute kernels that can be selected at startup
+typedef enum ComputeEngine
+{
+	SCALAR_ENGINE = 0,		//	one byte per cell, cellNewState() for each cell
+	SIMD_ENGINE,			//	same grid, 16 or 32 cells at a time (see simdGeneration.h)
+	BIT_PACKED_ENGINE,		//	64 cells per uint64_t word (see bitGrid.h)
+	HASHLIFE_ENGINE,		//	memoized quadtree on an unbounded plane (see hashlife.h)
+	//
+	NB_COMPUTE_ENGINES
+} ComputeEngine;
+
+//	How things are handled at the border of the frame.  Both grids are
+//	surrounded with a one-cell halo (see refreshHalo), so the computation
+//	itself never tests for the border, and the behavior can be changed at
+//	run time (--frame, or "frame <name>" through the pipe).
+typedef enum FrameBehavior
+{
+	FRAME_DEAD = 0,			//	cell borders are kept dead
+	FRAME_RANDOM,			//	the halo gets new random values at each generation
+	FRAME_CLIPPED,			//	same rule as elsewhere, with a dead halo
+	FRAME_WRAP,				//	same rule as elsewhere, with wrapping around at edges
+	//
+	NB_FRAME_BEHAVIORS
+} FrameBehavior;
+
+//	How a headless run reports its timings and stats
+typedef enum ReportFormat
+{
+	REPORT_TEXT = 0,		//	for people
+	REPORT_CSV,				//	a header line and one line of values
+	REPORT_JSON				//	one object on one line
+} ReportFormat;
+
 
 //==================================================================================
 //	Function prototypes
@@ -65,40 +150,54 @@ void displayGridPane(void);
 void displayStatePane(void);
 void initializeApplication(void);
 void* threadFunc(void*);
+void endOfGeneration(void);
+void startSimulation(void);
+void resetGrid(void);
+void publishGeneration(void);
+void setUpFrame(DisplayFrame* frame);
+void makeFramePart(unsigned int threadIndex);
+void makeFrameRows(unsigned int startRow, unsigned int endRow);
+void setRowsChanged(int startRow, int endRow);
+void findChangedRows(int startRow, int endRow);
+void getHomeRows(unsigned int threadIndex, int* startRow, int* endRow);
+void touchHomeRows(unsigned int threadIndex);
+void printPlacementReport(void);
 void swapGrids(void);
-unsigned int cellNewState(unsigned int i, unsigned int j);
+unsigned int cellNewState(int i, int j);
 void oneRowGeneration(int i);
+void oneRowSpanGeneration(int i, int startCol, int endCol);
+void oneCellGeneration(int i, int j);
+void bandGeneration(int startRow, int endRow);
+void rowsGeneration(int startRow, int endRow);
+int oneTileGeneration(int startRow, int endRow, int tileCol);
+void refreshHalo(void);
+void applyFrameBehavior(void);
+void applyRule(void);
 void* pipeServerThread(void*);
-
-//==================================================================================
-//	Precompiler #define to let us specify how things should be handled at the
-//	border of the frame
-//==================================================================================
-
-#define FRAME_FIXED			-1	//	the one demo-ed in class,
-#define FRAME_DEAD			0	//	cell borders are kept dead
-#define FRAME_RANDOM		1	//	new random values are generated at each generation
-#define FRAME_CLIPPED		2	//	same rule as elsewhere, with clipping to stay within bounds
-#define FRAME_WRAP			3	//	same rule as elsewhere, with wrapping around at edges
-
-//	Pick one value for FRAME_BEHAVIOR
-#define FRAME_BEHAVIOR	FRAME_DEAD
+unsigned long countLiveCells(void);
+void printHeadlessReport(void);
+double wallClockTime(void);
 
 //==================================================================================
 //	Application-level global variables
 //==================================================================================
 
 extern const int GRID_PANE, STATE_PANE;
+extern const int GRID_PANE_WIDTH, GRID_PANE_HEIGHT;
 extern int gMainWindow, gSubwindow[2];
 
 //	The state grid and its dimensions.  We now have two copies of the grid:
 //		- currentGrid is the one displayed in the graphic front end
 //		- nextGrid is the grid that stores the next generation of cell
 //			states, as computed by our threads.
-int* currentGrid;
-int* nextGrid;
-int** currentGrid2D;
-int** nextGrid2D;
+//	A cell's state (0 = dead, else its "age") fits in one byte.
+//	Both grids have a halo:  rows -1 and numRows, and columns -1 and numCols
+//	of the 2D grids can be accessed, and hold what the border cells see
+//	beyond the frame.
+uint8_t* currentGrid;
+uint8_t* nextGrid;
+uint8_t** currentGrid2D;
+uint8_t** nextGrid2D;
 
 int numRows, numCols;
 
@@ -107,25 +206,111 @@ int maxThreadCount;
 
 unsigned int numLiveThreads = 0;
 
-unsigned int rule = GAME_OF_LIFE_RULE;
+//	The rule currently applied, compiled into a lookup table (see rules.h).
+//	Like the frame behavior, a new rule is only applied between two
+//	generations:  it is compiled into requestedRule (under ruleLock, as the
+//	keyboard and the pipe may both ask for one), then copied into rule by
+//	endOfGeneration while the compute threads wait at the barrier.
+RuleTable rule;
+RuleTable requestedRule;
+atomic_bool ruleRequested = false;
+pthread_mutex_t ruleLock = PTHREAD_MUTEX_INITIALIZER;
 
 unsigned int colorMode = 0;
 
-int swapCounter;
+ComputeEngine engine = SIMD_ENGINE;
+const char* COMPUTE_ENGINE_STR[NB_COMPUTE_ENGINES] = {"scalar", "simd", "bits", "hashlife"};
+
+//	instruction set used by the SIMD engine, detected at startup
+SimdLevel simdLevel = SIMD_NONE;
 
-sem_t mutex;
+//	the hashlife engine advances by 2^hashlifeStepLog2 generations at a time
+unsigned int hashlifeStepLog2 = 0;
+
+//	skip the tiles whose neighborhood did not change (see activeTiles.h)
+bool useActiveTiles = true;
+
+//	color mode the tiles were last computed with
+unsigned int tilesColorMode = 0;
+
+//	Behavior at the border of the frame.  A new behavior requested through
+//	the pipe is only applied between two generations.
+FrameBehavior frameBehavior = FRAME_DEAD;
+FrameBehavior requestedFrameBehavior = FRAME_DEAD;
+
+//	Set by the front end (space bar):  the grid is reset between two generations
+atomic_bool resetRequested = false;
+
+const char* FRAME_BEHAVIOR_STR[NB_FRAME_BEHAVIORS] = {"dead", "random", "clipped", "wrap"};
 
 int sleepTimer = 100000;
 
+//	number of generations computed since the start
+unsigned long generationCount = 0;
+
 //------------------------------
 //	Threads and synchronization
-//	Reminder of all declarations and function calls
 //------------------------------
-pthread_mutex_t myLock;
-//int err = pthread_create(pthread_t*, NULL, threadFunc, ThreadInfo*);
-//int pthread_join(pthread_t , void**);
-//pthread_mutex_lock(&myLock);
-//pthread_mutex_unlock(&myLock);
+//	All the compute threads meet here at the end of every generation
+GenerationBarrier generationBarrier;
+
+//	...and here once, when they have touched their rows (see numaPlacement.h)
+GenerationBarrier startupBarrier;
+
+ThreadInfo* threads;
+
+//	pin the compute threads to one CPU each, report the placement of their rows
+bool pinThreads = false;
+bool numaReport = false;
+
+//------------------------------
+//	Headless runs
+//------------------------------
+//	With --generations or --seconds there is no window:  the threads compute
+//	as fast as they can until the first limit is reached (0 means no limit),
+//	then main prints the timings and stats of the run and exits.
+bool headless = false;
+unsigned long maxGenerations = 0;
+double maxSeconds = 0.0;
+
+//	Only set by endOfGeneration, while all the compute threads are at the barrier
+bool simulationDone = false;
+
+//	wall clock times (see wallClockTime) of the start of the program, and of
+//	the first and last generations
+double launchTime, computeStartTime, computeEndTime;
+
+//	end of the last generation, for the time of the next one (see generationTimes.h)
+double lastGenerationTime;
+
+ReportFormat reportFormat = REPORT_TEXT;
+
+//------------------------------
+//	Display frames
+//------------------------------
+//	Only the cells of the viewport (see viewport.h) are handed to the
+//	renderer, and if there are more of them than the grid pane has pixels,
+//	they are reduced to an image of the size of the pane (see
+//	gridReduction.h).  The compute threads make the frame together, each one
+//	a band of its rows, at most once per frame displayed.  Drawing then costs
+//	the same for any grid size.  The frames hold frameRows x frameCols cells.
+unsigned int frameRows, frameCols;
+ReductionMode reductionMode = REDUCE_MAX_AGE;
+
+//	Only set by endOfGeneration:  the threads make a frame of the generation they leave the barrier with
+bool makingFrame = false;
+
+//	bands of the frame still to make (the thread that does the last one publishes it)
+atomic_uint framePartsLeft;
+
+//	Generation each row of the grid last changed at, written by the thread
+//	that computes the row (NULL in headless runs, which don't track it)
+unsigned long* rowChangedAt = NULL;
+
+//	What the grid pane shows (see displayGridPane):  the generation and the
+//	image of the frame drawn last, and the rows of a new frame that differ
+DisplayFrame drawnFrame;
+uint8_t* changedFrameRows;
 
 
 void displayGridPane(void)
@@ -140,7 +325,24 @@ void displayGridPane(void)
 	//	This is the call that makes OpenGL render the grid.
 	//
 	//---------------------------------------------------------
-	drawGrid(currentGrid2D, numRows, numCols);
+	//	We never read the grids the threads work on:  we draw the latest
+	//	generation they published (see displayFrames.h)
+	const DisplayFrame* frame = getLatestFrame();
+
+	//	Only the rows that changed since the frame drawn last need to be
+	//	uploaded, if that frame was an image of the same cells
+	bool sameImage = (frame->imageRows == drawnFrame.imageRows && frame->imageCols == drawnFrame.imageCols &&
+					  frame->reduced == drawnFrame.reduced && (!frame->reduced || frame->mode == drawnFrame.mode) &&
+					  memcmp(&frame->view, &drawnFrame.view, sizeof(Viewport)) == 0);
+	for(unsigned int r = 0; r < frame->imageRows; r++)
+		changedFrameRows[r] = !sameImage || frame->rowChangedAt[r] > drawnFrame.generation;
+	drawnFrame = *frame;
+
+	if(frame->reduced)
+		drawReducedGrid(frame->rows, frame->imageRows, frame->imageCols, frame->mode == REDUCE_DENSITY,
+						changedFrameRows);
+	else
+		drawGrid(frame->rows, frame->imageRows, frame->imageCols, changedFrameRows);
 	
 	//	This is OpenGL/glut magic.
 	glutSwapBuffers();
@@ -161,8 +363,19 @@ void displayStatePane(void)
 	//	about the state of the simulation.
 	//---------------------------------------------------------
 	drawState(numLiveThreads, maxThreadCount);
-	drawRule(rule);
+	//	the rule last asked for (applied with the next generation)
+	RuleTable shownRule;
+	pthread_mutex_lock(&ruleLock);
+	shownRule = requestedRule;
+	pthread_mutex_unlock(&ruleLock);
+	drawRule(&shownRule);
 	drawSleepTimer();
+	drawFrameBehavior(engine == HASHLIFE_ENGINE ? "unbounded" : FRAME_BEHAVIOR_STR[frameBehavior]);
+	Viewport view;
+	getViewport(&view);
+	bool reduced = (view.numRows > (unsigned int) GRID_PANE_HEIGHT || view.numCols > (unsigned int) GRID_PANE_WIDTH);
+	drawRenderMode(reduced ? REDUCTION_MODE_STR[reductionMode] : "cells", &view, getViewportZoom());
+	drawFrameStats();
 	drawTitle();
 	
 	
@@ -177,23 +390,161 @@ void displayStatePane(void)
  */
 int main(int argc, char** argv)
 {
-	if(argc < 3 || argc > 4)	// if there are too little or too many parameters, print error and exit
+	//	Optional arguments first (getopt moves them out of the way, so they may
+	//	appear anywhere on the command line)
+	static struct option longOptions[] = {
+		{"engine",	required_argument,	NULL,	'e'},
+		{"rule",	required_argument,	NULL,	'r'},
+		{"step",	required_argument,	NULL,	'k'},
+		{"active-tiles",	required_argument,	NULL,	't'},
+		{"frame",	required_argument,	NULL,	'f'},
+		{"pin",		no_argument,		NULL,	'p'},
+		{"numa-report",	no_argument,	NULL,	'n'},
+		{"generations",	required_argument,	NULL,	'g'},
+		{"seconds",	required_argument,	NULL,	'd'},
+		{"report",	required_argument,	NULL,	'o'},
+		{"color",	required_argument,	NULL,	'c'},
+		{"fps",		required_argument,	NULL,	'F'},
+		{NULL,		0,					NULL,	0}
+	};
+	int opt;
+	launchTime = wallClockTime();
+	//	--rule and --frame are only applied once the engine is known, as it may come after them
+	const char* ruleArg = "1";
+	const char* frameArg = NULL;
+	while((opt = getopt_long(argc, argv, "e:r:k:t:f:png:d:o:c:F:", longOptions, NULL)) != -1)
 	{
-		printf("\n\nMust enter correct format(s): \t./cell 'rows' 'columns' 'max thread count'\n\t\t\t./cell 'rows' 'columns'\n");
+		switch(opt)
+		{
+			case 'e':
+				if(strcmp(optarg, "scalar") == 0)
+					engine = SCALAR_ENGINE;
+				else if(strcmp(optarg, "simd") == 0)
+					engine = SIMD_ENGINE;
+				else if(strcmp(optarg, "bits") == 0)
+					engine = BIT_PACKED_ENGINE;
+				else if(strcmp(optarg, "hashlife") == 0)
+					engine = HASHLIFE_ENGINE;
+				else
+				{
+					printf("\n\nUnknown engine '%s' (must be scalar, simd, bits or hashlife).\n\n", optarg);
+					exit(0);
+				}
+				break;
+
+			case 'r':
+				ruleArg = optarg;
+				break;
+
+			case 'k':
+				if(sscanf(optarg, "%u", &hashlifeStepLog2) != 1 || hashlifeStepLog2 > HASHLIFE_MAX_STEP_LOG2)
+				{
+					printf("\n\nThe step must be a number between 0 and %d.\n\n", HASHLIFE_MAX_STEP_LOG2);
+					exit(0);
+				}
+				break;
+
+			case 't':
+				if(strcmp(optarg, "on") == 0)
+					useActiveTiles = true;
+				else if(strcmp(optarg, "off") == 0)
+					useActiveTiles = false;
+				else
+				{
+					printf("\n\n--active-tiles must be on or off.\n\n");
+					exit(0);
+				}
+				break;
+
+			case 'f':
+				frameArg = optarg;
+				break;
+
+			case 'p':
+				pinThreads = true;
+				break;
+
+			case 'n':
+				numaReport = true;
+				break;
+
+			case 'g':
+				if(sscanf(optarg, "%lu", &maxGenerations) != 1 || maxGenerations == 0)
+				{
+					printf("\n\nThe number of generations must be a positive integer.\n\n");
+					exit(0);
+				}
+				headless = true;
+				break;
+
+			case 'd':
+				if(sscanf(optarg, "%lf", &maxSeconds) != 1 || maxSeconds <= 0.0)
+				{
+					printf("\n\nThe number of seconds must be positive.\n\n");
+					exit(0);
+				}
+				headless = true;
+				break;
+
+			case 'o':
+				if(strcmp(optarg, "text") == 0)
+					reportFormat = REPORT_TEXT;
+				else if(strcmp(optarg, "csv") == 0)
+					reportFormat = REPORT_CSV;
+				else if(strcmp(optarg, "json") == 0)
+					reportFormat = REPORT_JSON;
+				else
+				{
+					printf("\n\n--report must be text, csv or json.\n\n");
+					exit(0);
+				}
+				break;
+
+			case 'c':
+				if(strcmp(optarg, "on") == 0)
+					colorMode = 1;
+				else if(strcmp(optarg, "off") == 0)
+					colorMode = 0;
+				else
+				{
+					printf("\n\n--color must be on or off.\n\n");
+					exit(0);
+				}
+				break;
+
+			case 'F':
+				if(setTargetFps(atof(optarg)) != 0)
+				{
+					printf("\n\nThe frame rate must be between 1 and %d.\n\n", MAX_TARGET_FPS);
+					exit(0);
+				}
+				break;
+
+			default:
+				exit(0);
+		}
+	}
+	int numArgs = argc - optind + 1;		// positional parameters, counting the program name like argc does
+	char** args = argv + optind - 1;
+
+	if(numArgs < 3 || numArgs > 4)	// if there are too little or too many parameters, print error and exit
+	{
+		printf("\n\nMust enter correct format(s): \t./cell 'rows' 'columns' 'max thread count' [options]\n\t\t\t./cell 'rows' 'columns' [options]\n");
+		printf("\nOptions:\t--engine scalar|simd|bits|hashlife\n\t\t--rule B3/S23\n\t\t--step k\n\t\t--active-tiles on|off\n\t\t--frame dead|wrap|clipped|random\n\t\t--pin\n\t\t--numa-report\n\t\t--generations n\n\t\t--seconds t\n\t\t--report text|csv|json\n\t\t--color on|off\n\t\t--fps n\n");
 		exit(0);
 	}
 	else
 	{
-		if(argc == 4)			// if there are 4 parameters, set the corresponding values for rows, columns, and max thread count
+		if(numArgs == 4)			// if there are 4 parameters, set the corresponding values for rows, columns, and max thread count
 		{
-			sscanf(argv[1], "%d", &numRows);
-			sscanf(argv[2], "%d", &numCols);
-			sscanf(argv[3], "%d", &maxThreadCount);
+			sscanf(args[1], "%d", &numRows);
+			sscanf(args[2], "%d", &numCols);
+			sscanf(args[3], "%d", &maxThreadCount);
 		}
-		else if(argc == 3)		// else if there are 3 parameters, set the corresponding values for rows and columns, then set max thread count to row count
+		else if(numArgs == 3)		// else if there are 3 parameters, set the corresponding values for rows and columns, then set max thread count to row count
 		{
-			sscanf(argv[1], "%d", &numRows);
-			sscanf(argv[2], "%d", &numCols);
+			sscanf(args[1], "%d", &numRows);
+			sscanf(args[2], "%d", &numCols);
 			maxThreadCount = numRows;
 		}
 
@@ -209,6 +560,28 @@ int main(int argc, char** argv)
 		}
 	}
 
+	RuleTable ruleCheck;
+	if(parseRule(ruleArg, &ruleCheck) != 0)
+	{
+		printf("\n\nInvalid rule '%s' (expected e.g. B3/S23, or a number 1-4).\n\n", ruleArg);
+		exit(0);
+	}
+	if(engine == HASHLIFE_ENGINE && (ruleCheck.birthMask & 1))		// nothing can be born from nothing on an unbounded plane
+	{
+		printf("\n\nThe hashlife engine cannot run rules with B0.\n\n");
+		exit(0);
+	}
+	setRule(ruleArg);
+
+	if(frameArg != NULL && setFrameBehavior(frameArg) != 0)
+	{
+		if(engine == HASHLIFE_ENGINE)		// the plane of hashlife has no border
+			printf("\n\nThe hashlife engine runs on an unbounded plane, --frame does not apply.\n\n");
+		else
+			printf("\n\nUnknown frame behavior '%s' (must be dead, wrap, clipped or random).\n\n", frameArg);
+		exit(0);
+	}
+
 	// creating the server thread for the named pipe
 	pthread_t serverID;
 	int serverCode = pthread_create(&serverID, NULL, pipeServerThread, NULL);
@@ -219,47 +592,32 @@ int main(int argc, char** argv)
 	}
 
 
-	//	This takes care of initializing glut and the GUI.
-	initializeFrontEnd(argc, argv, displayGridPane, displayStatePane);
+	//	This takes care of initializing glut and the GUI (a headless run has
+	//	no window, and needs no display)
+	if(!headless)
+		initializeFrontEnd(argc, argv, displayGridPane, displayStatePane);
 	
 	//	Now we can do application-level initialization
 	initializeApplication();
 
 	//	Now would be the place & time to create mutex locks and threads
 
-	// declare the array of ThreadInfo structs
-	ThreadInfo threads[maxThreadCount];
+	// allocate the array of ThreadInfo structs
+	threads = (ThreadInfo*) malloc(maxThreadCount * sizeof(ThreadInfo));
 
-	// declare the pthread mutex lock
-	pthread_mutex_init(&myLock, NULL);
+	// the barriers are sized for all the threads before any of them starts
+	initializeBarrier(&startupBarrier, maxThreadCount);
+	initializeBarrier(&generationBarrier, maxThreadCount);
 
-	// declare the semaphore mutex lock to handle grid swapping
-	sem_init(&mutex, 0, 1);
+	// the rows are not split in fixed bands:  each thread starts every generation with an equal
+	// share of the row blocks, and steals blocks from the others once its share is done
+	initializeScheduler(maxThreadCount, (numRows + ROWS_PER_BLOCK - 1) / ROWS_PER_BLOCK);
 
 	int errCode;		
-	int startIndex = 0;
-	int endIndex;
-	int numRowsPerThread = numRows / maxThreadCount;
-	int numRowsRemaining = numRows;
 	for(int i = 0; i < maxThreadCount; i++)		// for loop to loop through and create determined number of threads
 	{
-		// if we are on the last thread, then assign the remaining rows to the thread
-		if(i == maxThreadCount - 1)			
-		{
-			endIndex = startIndex + numRowsRemaining;
-		}
-		// else if we are on a thread that is not the last, assign the determined number of rows per thread
-		// and decrement that number from the number of rows remaining
-		else
-		{
-			endIndex = startIndex + numRowsPerThread;
-			numRowsRemaining -= numRowsPerThread;
-		}
-
 		// assign the values to the indexed ThreadInfo struct 
 		threads[i].index = i;					// index of given thread in ThreadInfo array
-		threads[i].startIndex = startIndex;		// starting row index assigned to the given thread
-		threads[i].endIndex = endIndex;			// ending row index assigned to the given thread (exclusive)
 
 		// create the pthread
 		errCode = pthread_create(&threads[i].threadID, NULL, threadFunc, &threads[i]);
@@ -274,27 +632,48 @@ int main(int argc, char** argv)
 					 i, errCode, strerror(errCode));
 			exit(0);
 		}
-
-		// set the starting index of the next thread to the end index of the current thread
-		startIndex = endIndex;
 	}
 
+	//	A headless run ends by itself:  wait for the threads, then report
+	if(headless)
+	{
+		for(int i = 0; i < maxThreadCount; i++)
+			pthread_join(threads[i].threadID, NULL);
+		numLiveThreads = 0;
+
+		printHeadlessReport();
+	}
 	//	Now we enter the main loop of the program and to a large extend
 	//	"lose control" over its execution.  The callback functions that 
 	//	we set up earlier will be called when the corresponding event
 	//	occurs
-	glutMainLoop();
+	else
+		glutMainLoop();
 	
-	//	In fact this code is never reached because we only leave the glut main
-	//	loop through an exit call.
+	//	In fact this code is only reached by headless runs, because we only
+	//	leave the glut main loop through an exit call.
 	//	Free allocated resource before leaving (not absolutely needed, but
 	//	just nicer.
-	free(currentGrid2D);
+	free(currentGrid2D - 1);
 	free(currentGrid);
+	if(engine == BIT_PACKED_ENGINE)
+		freeBitGrid();
+	if(engine == HASHLIFE_ENGINE)
+		freeHashlife();
+	if(useActiveTiles)
+		freeActiveTiles();
+	if(!headless)
+		freeDisplayFrames();
+	else
+		freeGenerationTimes();
+	destroyBarrier(&startupBarrier);
+	destroyBarrier(&generationBarrier);
+	freeScheduler();
+	free(threads);
 	
 	
-	//	This will never be executed (the exit point will be in one of the
-	//	call back functions).
+	//	Only executed by headless runs (otherwise the exit point will be in
+	//	one of the call back functions).
 	return 0;
 }
 
@@ -331,27 +710,62 @@ void* pipeServerThread(void *unused)
  */
 void initializeApplication(void)
 {
-    //  Allocate 1D grids
-    //--------------------
-    currentGrid = (int*) malloc(numRows*numCols*sizeof(int));
-    nextGrid = (int*) malloc(numRows*numCols*sizeof(int));
+    //  Allocate 1D grids, with room for the halo
+    //--------------------------------------------
+    currentGrid = (uint8_t*) calloc((numRows+2)*(numCols+2), sizeof(uint8_t));
+    nextGrid = (uint8_t*) calloc((numRows+2)*(numCols+2), sizeof(uint8_t));
 
-    //  Scaffold 2D arrays on top of the 1D arrays
+    //  Scaffold 2D arrays on top of the 1D arrays, so that
+    //  grid2D[-1..numRows][-1..numCols] are valid
     //---------------------------------------------
-    currentGrid2D = (int**) malloc(numRows*sizeof(int*));
-    nextGrid2D = (int**) malloc(numRows*sizeof(int*));
-    currentGrid2D[0] = currentGrid;
-    nextGrid2D[0] = nextGrid;
-    for (int i=1; i<numRows; i++)
+    currentGrid2D = (uint8_t**) malloc((numRows+2)*sizeof(uint8_t*)) + 1;
+    nextGrid2D = (uint8_t**) malloc((numRows+2)*sizeof(uint8_t*)) + 1;
+    for (int i=-1; i<=numRows; i++)
     {
-        currentGrid2D[i] = currentGrid2D[i-1] + numCols;
-        nextGrid2D[i] = nextGrid2D[i-1] + numCols;
+        currentGrid2D[i] = currentGrid + (i+1)*(numCols+2) + 1;
+        nextGrid2D[i] = nextGrid + (i+1)*(numCols+2) + 1;
     }
+
+	if(engine == BIT_PACKED_ENGINE)
+		initializeBitGrid(numRows, numCols);
+
+	if(engine == HASHLIFE_ENGINE)
+		initializeHashlife();
+
+	//	hashlife does its own skipping of what doesn't change
+	if(engine == HASHLIFE_ENGINE)
+		useActiveTiles = false;
+	if(useActiveTiles)
+	{
+		initializeActiveTiles(numRows, numCols);
+	}
+	applyFrameBehavior();
+	applyRule();
+
+	//	pick the widest vector instructions this CPU supports
+	if(engine == SIMD_ENGINE)
+		simdLevel = detectSimdLevel();
 	
+	//	copies of the viewport (or of its image, if it is larger than the
+	//	pane) handed to the renderer, if there is one, else the times of the
+	//	generations for the report
+	if(!headless)
+	{
+		initializeViewport(numRows, numCols);
+		reducedSize(numRows, numCols, GRID_PANE_HEIGHT, GRID_PANE_WIDTH, &frameRows, &frameCols);
+		initializeDisplayFrames(frameRows, frameCols);
+		rowChangedAt = (unsigned long*) calloc(numRows, sizeof(unsigned long));
+		changedFrameRows = (uint8_t*) malloc(frameRows*sizeof(uint8_t));
+		drawnFrame.imageRows = 0;
+	}
+	else	// hashlife records one time per step of 2^k generations
+		initializeGenerationTimes(engine == HASHLIFE_ENGINE ? (maxGenerations >> hashlifeStepLog2) + 1 : maxGenerations);
+
 	//	seed the pseudo-random generator
 	srand((unsigned int) time(NULL));
-	
-	resetGrid();
+
+	//	The grids are only filled once the compute threads have touched
+	//	their own rows (see startSimulation)
 }
 
 /*
@@ -361,41 +775,452 @@ void* threadFunc(void* arg)
 {
 	ThreadInfo* info = (ThreadInfo *) arg;
 
+	// pin the thread if asked, then be the first to write to our own rows, so that
+	// their pages land on our NUMA node.  The last thread done fills the grid.
+	if(pinThreads)
+		pinThreadToCpu(info->index);
+	touchHomeRows(info->index);
+	getCpuAndNode(&info->cpu, &info->node);
+	barrierWait(&startupBarrier, startSimulation);
+
 	// while loop to continue calculating the next generation of cells 
-	while(1)
+	while(!simulationDone)
 	{
-		// get the mutex lock for the grid array
-		pthread_mutex_lock(&myLock);
+		// hashlife is not split in blocks:  the first thread advances the whole
+		// universe, then copies the window shown by the front end into the next grid
+		if(engine == HASHLIFE_ENGINE)
+		{
+			if(info->index == 0)
+			{
+				hashlifeStep(hashlifeStepLog2, rule.birthMask, rule.surviveMask);
+				hashlifeExport(nextGrid2D, numRows, numCols);
+				findChangedRows(0, numRows);
+			}
+		}
+		else
+		{
+			// compute row blocks (our own, then other threads') until there are none left
+			int block;
+			while((block = nextBlock(info->index)) >= 0)
+			{
+				int startRow = block * ROWS_PER_BLOCK;
+				int endRow = (startRow + ROWS_PER_BLOCK < numRows) ? startRow + ROWS_PER_BLOCK : numRows;
+				rowsGeneration(startRow, endRow);
+			}
+		}
+
+		// wait for the other threads:  the last one to be done swaps the grids
+		// for everybody.  Then they all hand the new generation to the renderer,
+		// and the last one gives it some screen time (outside of the barrier,
+		// while the others already compute the next one).  Without a renderer,
+		// there is no wait.
+		bool lastToArrive = barrierWait(&generationBarrier, endOfGeneration);
+
+		if(makingFrame)
+			makeFramePart(info->index);
 
-		// loop through each of the threads assigned rows in the grid array
-		for(int i = info->startIndex; i < info->endIndex; i++)
+		if(lastToArrive && !headless)
+			usleep(sleepTimer);
+	}
+	return NULL;
+}
+
+//	Rows [startRow, endRow) of the row blocks a thread starts every generation with
+void getHomeRows(unsigned int threadIndex, int* startRow, int* endRow)
+{
+	unsigned int firstBlock, lastBlock;
+	getHomeBlocks(threadIndex, &firstBlock, &lastBlock);
+
+	*startRow = (int) firstBlock * ROWS_PER_BLOCK;
+	*endRow = ((int) lastBlock * ROWS_PER_BLOCK < numRows) ? (int) lastBlock * ROWS_PER_BLOCK : numRows;
+}
+
+/*
+ * Writes zeros over the rows the given thread starts every generation with,
+ * in the grids of the selected engine (first touch, see numaPlacement.h)
+ */
+void touchHomeRows(unsigned int threadIndex)
+{
+	int startRow, endRow;
+	getHomeRows(threadIndex, &startRow, &endRow);
+	if(startRow >= endRow)
+		return;
+
+	// the byte grids are always used, if only for display
+	memset(currentGrid2D[startRow] - 1, 0, (endRow - startRow)*(numCols+2));
+	memset(nextGrid2D[startRow] - 1, 0, (endRow - startRow)*(numCols+2));
+	if(engine == BIT_PACKED_ENGINE)
+		bitGridTouchRows(startRow, endRow);
+}
+
+/*
+ * Called once by the last compute thread to be ready, while all the others
+ * are blocked:  fills the grid for the first generation.
+ */
+void startSimulation(void)
+{
+	resetGrid();
+	publishGeneration();
+
+	if(numaReport)
+		printPlacementReport();
+
+	computeStartTime = wallClockTime();
+	lastGenerationTime = computeStartTime;
+}
+
+/*
+ * Prints, for every compute thread, where it ran and on which NUMA nodes
+ * the pages of its rows ended up
+ */
+void printPlacementReport(void)
+{
+	printf("\nThread placement (%s):\n", pinThreads ? "pinned" : "not pinned");
+	for(int t = 0; t < maxThreadCount; t++)
+	{
+		int startRow, endRow;
+		getHomeRows(t, &startRow, &endRow);
+
+		printf("\tthread %2d  cpu %3d  node %2d  rows %5d-%5d  pages:", t, threads[t].cpu, threads[t].node,
+			   startRow, endRow-1);
+		if(startRow >= endRow)
 		{
-			oneRowGeneration(i);
+			printf(" none\n");
+			continue;
 		}
 
-		// get the semaphore mutex lock to check if we are ready to swap grids (all thread computation completed)
-		sem_wait(&mutex);
-		swapCounter++;
+		// look at the grid the engine computes into
+		const void* start;
+		size_t length;
+		if(engine == BIT_PACKED_ENGINE)
+			length = bitGridRowsMemory(startRow, endRow, &start);
+		else
+		{
+			start = currentGrid2D[startRow] - 1;
+			length = (endRow - startRow)*(numCols+2);
+		}
 
-		// if every thread has done its computations for the next generation, sleep for designated time then swap grids and reset swap counter
-		if(swapCounter == numLiveThreads)
+		unsigned int pageCount[MAX_NUMA_NODES + 1];
+		countPagesPerNode(start, length, pageCount);
+		for(int n = 0; n < MAX_NUMA_NODES; n++)
 		{
-			usleep(sleepTimer);
-			swapGrids();
-			swapCounter = 0;
+			if(pageCount[n] != 0)
+				printf(" node %d: %u", n, pageCount[n]);
 		}
+		if(pageCount[MAX_NUMA_NODES] != 0)
+			printf(" unknown: %u", pageCount[MAX_NUMA_NODES]);
+		printf("\n");
+	}
+	fflush(stdout);
+}
 
-		// release the semaphore lock and grid array lock
-		sem_post(&mutex);
-		pthread_mutex_unlock(&myLock);
+/*
+ * Prints the timings and final state of a headless run, once all the compute
+ * threads are done
+ */
+void printHeadlessReport(void)
+{
+	double computeTime = computeEndTime - computeStartTime;
+	double numCells = (double) numRows * numCols;
+	unsigned long numLive = countLiveCells();
+	const char* frameName = (engine == HASHLIFE_ENGINE) ? "unbounded" : FRAME_BEHAVIOR_STR[frameBehavior];
+	const char* simdName = (engine == SIMD_ENGINE) ? simdLevelName(simdLevel) : "none";
+
+	// a time is recorded per generation, or per step of 2^k generations for hashlife
+	unsigned long generationsPerStep = (engine == HASHLIFE_ENGINE) ? (1ul << hashlifeStepLog2) : 1;
+	double generationRate = (computeTime > 0.0) ? generationCount / computeTime : 0.0;
+	double meanTime = meanGenerationTime(),
+		   p50 = generationTimePercentile(50.0),
+		   p90 = generationTimePercentile(90.0),
+		   p99 = generationTimePercentile(99.0),
+		   maxTime = generationTimePercentile(100.0);
+
+	if(reportFormat == REPORT_CSV)
+	{
+		printf("engine,simd,rows,cols,threads,rule,color,frame,generations,generations_per_step,seconds,"
+			   "setup_seconds,generations_per_s,cells_per_s,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,live_cells\n");
+		printf("%s,%s,%d,%d,%d,%s,%s,%s,%lu,%lu,%.6f,%.6f,%.3f,%.6g,%.4f,%.4f,%.4f,%.4f,%.4f,%lu\n",
+			   COMPUTE_ENGINE_STR[engine], simdName, numRows, numCols, maxThreadCount, rule.str,
+			   colorMode ? "on" : "off", frameName, generationCount, generationsPerStep, computeTime,
+			   computeStartTime - launchTime, generationRate, generationRate * numCells,
+			   1000.0*meanTime, 1000.0*p50, 1000.0*p90, 1000.0*p99, 1000.0*maxTime, numLive);
+	}
+	else if(reportFormat == REPORT_JSON)
+	{
+		printf("{\"engine\": \"%s\", \"simd\": \"%s\", \"rows\": %d, \"cols\": %d, \"threads\": %d, "
+			   "\"rule\": \"%s\", \"color\": \"%s\", \"frame\": \"%s\", \"generations\": %lu, "
+			   "\"generations_per_step\": %lu, \"seconds\": %.6f, \"setup_seconds\": %.6f, "
+			   "\"generations_per_s\": %.3f, \"cells_per_s\": %.6g, \"mean_ms\": %.4f, \"p50_ms\": %.4f, "
+			   "\"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f, \"live_cells\": %lu}\n",
+			   COMPUTE_ENGINE_STR[engine], simdName, numRows, numCols, maxThreadCount, rule.str,
+			   colorMode ? "on" : "off", frameName, generationCount, generationsPerStep, computeTime,
+			   computeStartTime - launchTime, generationRate, generationRate * numCells,
+			   1000.0*meanTime, 1000.0*p50, 1000.0*p90, 1000.0*p99, 1000.0*maxTime, numLive);
+	}
+	else
+	{
+		printf("\nHeadless run:  %d x %d cells, %d threads, engine %s", numRows, numCols, maxThreadCount,
+			   COMPUTE_ENGINE_STR[engine]);
+		if(engine == SIMD_ENGINE)
+			printf(" (%s)", simdName);
+		printf(", rule %s, frame %s, color %s\n", rule.str, frameName, colorMode ? "on" : "off");
+
+		printf("\tsetup:         %.3f s\n", computeStartTime - launchTime);
+		printf("\tgenerations:   %lu in %.3f s\n", generationCount, computeTime);
+		printf("\t               %.1f generations/s, %.4g cells/s\n", generationRate, generationRate * numCells);
+		printf("\t%-15smean %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f ms\n",
+			   generationsPerStep > 1 ? "step:" : "generation:", 1000.0*meanTime,
+			   1000.0*p50, 1000.0*p90, 1000.0*p99, 1000.0*maxTime);
+		printf("\tlive cells:    %lu of %.0f (%.1f%%)\n", numLive, numCells, 100.0 * numLive / numCells);
+	}
+	fflush(stdout);
+}
 
-		usleep(5000);
+/*
+ * Number of live cells in the current generation.  Only called when no
+ * generation is being computed.
+ */
+unsigned long countLiveCells(void)
+{
+	// the bit-packed engine keeps its own grid, and doesn't use the byte grids
+	uint8_t** grid = currentGrid2D;
+	if(engine == BIT_PACKED_ENGINE)
+	{
+		bitGridExport(nextGrid2D);
+		grid = nextGrid2D;
 	}
-	return NULL;
+
+	unsigned long numLive = 0;
+	for(int i = 0; i < numRows; i++)
+		for(int j = 0; j < numCols; j++)
+			numLive += (grid[i][j] != 0);
+	return numLive;
+}
+
+//	Seconds on a clock that doesn't jump, for the timings of headless runs
+double wallClockTime(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + 1.e-9*now.tv_nsec;
+}
+
+/*
+ * Called once per generation by the last thread to reach the barrier, while
+ * all the other threads are blocked:  makes the generation just computed
+ * the current one.
+ */
+void endOfGeneration(void)
+{
+	// hashlife may advance more than one generation per step
+	generationCount += (engine == HASHLIFE_ENGINE) ? (1ul << hashlifeStepLog2) : 1;
+
+	// the bit-packed engine has its own pair of grids
+	if(engine == BIT_PACKED_ENGINE)
+		bitGridSwap();
+	else
+		swapGrids();
+
+	// a new frame behavior or rule takes effect with the next generation
+	if(requestedFrameBehavior != frameBehavior)
+		applyFrameBehavior();
+	if(atomic_load(&ruleRequested))
+		applyRule();
+	refreshHalo();
+
+	// a reset asked for during the generation replaces it (before the tiles
+	// are swapped, so that they all get computed next)
+	if(atomic_exchange(&resetRequested, false))
+		resetGrid();
+
+	if(useActiveTiles)
+	{
+		swapTileFlags();
+		// in color mode, cells that don't move still get older
+		if(colorMode != tilesColorMode)
+		{
+			tilesColorMode = colorMode;
+			markAllTilesChanged();
+		}
+	}
+
+	// every thread gets its share of the row blocks back
+	resetScheduler();
+
+	// a headless run is over when it reaches its number of generations or its time,
+	// and all the threads see it when they leave the barrier
+	if(headless)
+	{
+		double now = wallClockTime();
+		recordGenerationTime(now - lastGenerationTime);
+		lastGenerationTime = now;
+
+		if((maxGenerations > 0 && generationCount >= maxGenerations) ||
+		   (maxSeconds > 0.0 && now - computeStartTime >= maxSeconds))
+		{
+			computeEndTime = now;
+			simulationDone = true;
+		}
+	}
+
+	// the threads make a frame of the new generation if the renderer wants one
+	if(!headless)
+	{
+		makingFrame = frameWanted();
+		if(makingFrame)
+		{
+			setUpFrame(getBackFrame());
+			atomic_store(&framePartsLeft, (unsigned int) maxThreadCount);
+		}
+	}
+}
+
+/*
+ * Makes a display frame of the current generation and publishes it for the
+ * renderer, unless the renderer hasn't even taken the previous one yet.
+ * Only called at startup:  the frames of the next generations are made by
+ * all the threads (see makeFramePart).
+ */
+void publishGeneration(void)
+{
+	if(headless || !frameWanted())
+		return;
+
+	DisplayFrame* frame = getBackFrame();
+	setUpFrame(frame);
+	makeFrameRows(0, frame->imageRows);
+
+	publishFrame(generationCount);
+}
+
+//	Sets the viewport the frame will show, and whether and how it is reduced
+void setUpFrame(DisplayFrame* frame)
+{
+	getViewport(&frame->view);
+	reducedSize(frame->view.numRows, frame->view.numCols, GRID_PANE_HEIGHT, GRID_PANE_WIDTH,
+				&frame->imageRows, &frame->imageCols);
+	frame->reduced = (frame->imageRows < frame->view.numRows || frame->imageCols < frame->view.numCols);
+	frame->mode = reductionMode;
+}
+
+/*
+ * Makes the band of rows of the back display frame of the given thread, and
+ * publishes the frame if it was the last band left.  Called by every thread
+ * after a barrier at which endOfGeneration set makingFrame.
+ * The current grid doesn't change until the next barrier, which the calling
+ * thread has to reach too, so this can be done while the others compute.
+ */
+void makeFramePart(unsigned int threadIndex)
+{
+	unsigned int imageRows = getBackFrame()->imageRows;
+	makeFrameRows(blockStart(threadIndex, imageRows, maxThreadCount),
+				  blockStart(threadIndex+1, imageRows, maxThreadCount));
+
+	if(atomic_fetch_sub(&framePartsLeft, 1) == 1)
+		publishFrame(generationCount);
 }
 
 /*
- * Function to reset the grid values
+ * Copies (or reduces) the cells of the viewport into the rows [startRow,
+ * endRow) of the back display frame
+ */
+void makeFrameRows(unsigned int startRow, unsigned int endRow)
+{
+	DisplayFrame* frame = getBackFrame();
+	const Viewport* view = &frame->view;
+	unsigned int firstGridRow = view->firstRow + blockStart(startRow, view->numRows, frame->imageRows),
+				 endGridRow = view->firstRow + blockStart(endRow, view->numRows, frame->imageRows);
+	if(firstGridRow >= endGridRow)
+		return;
+
+	// the bit-packed engine only keeps its own grid up to date, so unpack the
+	// cells needed into the byte grid it doesn't use
+	uint8_t** grid = currentGrid2D;
+	if(engine == BIT_PACKED_ENGINE)
+	{
+		bitGridExportRegion(nextGrid2D, firstGridRow, endGridRow, view->firstCol, view->firstCol + view->numCols);
+		grid = nextGrid2D;
+	}
+
+	for(unsigned int r = startRow; r < endRow; r++)
+	{
+		unsigned int i = view->firstRow + blockStart(r, view->numRows, frame->imageRows),
+					 endBlockRow = view->firstRow + blockStart(r+1, view->numRows, frame->imageRows);
+		if(frame->reduced)
+			reduceBlockRow(grid + i, endBlockRow - i, view->firstCol, view->numCols,
+						   frame->rows[r], frame->imageCols, frame->mode);
+		else
+			memcpy(frame->rows[r], grid[i] + view->firstCol, view->numCols);
+
+		// a row of the image changed when any of the grid rows it shows did
+		frame->rowChangedAt[r] = 0;
+		for(; i < endBlockRow; i++)
+		{
+			if(rowChangedAt[i] > frame->rowChangedAt[r])
+				frame->rowChangedAt[r] = rowChangedAt[i];
+		}
+	}
+}
+
+/*
+ * Notes that the rows [startRow, endRow) of the next generation differ from
+ * the current one (see displayGridPane)
+ */
+void setRowsChanged(int startRow, int endRow)
+{
+	if(rowChangedAt == NULL)
+		return;
+
+	for(int i = startRow; i < endRow; i++)
+		rowChangedAt[i] = generationCount + 1;
+}
+
+//	Same, for those of the rows [startRow, endRow) of the next byte grid that do
+void findChangedRows(int startRow, int endRow)
+{
+	if(rowChangedAt == NULL)
+		return;
+
+	for(int i = startRow; i < endRow; i++)
+	{
+		if(memcmp(nextGrid2D[i], currentGrid2D[i], numCols) != 0)
+			rowChangedAt[i] = generationCount + 1;
+	}
+}
+
+/*
+ * Computes the rows [startRow, endRow) of the next generation with the selected engine
+ */
+void rowsGeneration(int startRow, int endRow)
+{
+	if(useActiveTiles)
+	{
+		bandGeneration(startRow, endRow);
+	}
+	else if(engine == BIT_PACKED_ENGINE)
+	{
+		bitGridRowsGeneration(startRow, endRow,
+							  rule.birthMask, rule.surviveMask,
+							  frameBehavior == FRAME_DEAD);
+		for(int i = startRow; i < endRow && rowChangedAt != NULL; i++)
+		{
+			if(bitGridRowChanged(i))
+				setRowsChanged(i, i+1);
+		}
+	}
+	else
+	{
+		for(int i = startRow; i < endRow; i++)
+		{
+			oneRowGeneration(i);
+		}
+		findChangedRows(startRow, endRow);
+	}
+}
+
+/*
+ * Function to reset the grid values.  Only called while all the compute
+ * threads are blocked (at the start, or at the end of a generation)
  */
 void resetGrid(void)
 {
@@ -407,6 +1232,161 @@ void resetGrid(void)
 		}
 	}
 	swapGrids();
+
+	if(engine == BIT_PACKED_ENGINE)
+		bitGridImport(currentGrid2D);
+	if(engine == HASHLIFE_ENGINE)
+		hashlifeImport(currentGrid2D, numRows, numCols);
+	refreshHalo();
+	if(useActiveTiles)
+		markAllTilesChanged();
+	setRowsChanged(0, numRows);
+}
+
+/*
+ * Fills the halo of the current grid according to the frame behavior.
+ * Called whenever a new current grid is made (swap or reset).
+ */
+void refreshHalo(void)
+{
+	//	the bit-packed engine has its own grids, and hashlife has no border
+	if(engine == BIT_PACKED_ENGINE)
+	{
+		bitGridRefreshHalo(frameBehavior == FRAME_WRAP, frameBehavior == FRAME_RANDOM);
+		return;
+	}
+	if(engine == HASHLIFE_ENGINE)
+		return;
+
+	//	left and right columns
+	for (int i=0; i<numRows; i++)
+	{
+		if (frameBehavior == FRAME_WRAP)
+		{
+			currentGrid2D[i][-1] = currentGrid2D[i][numCols-1];
+			currentGrid2D[i][numCols] = currentGrid2D[i][0];
+		}
+		else if (frameBehavior == FRAME_RANDOM)
+		{
+			currentGrid2D[i][-1] = rand() % 2;
+			currentGrid2D[i][numCols] = rand() % 2;
+		}
+		else
+		{
+			currentGrid2D[i][-1] = 0;
+			currentGrid2D[i][numCols] = 0;
+		}
+	}
+
+	//	top and bottom rows, corners included
+	if (frameBehavior == FRAME_WRAP)
+	{
+		memcpy(currentGrid2D[-1] - 1, currentGrid2D[numRows-1] - 1, numCols+2);
+		memcpy(currentGrid2D[numRows] - 1, currentGrid2D[0] - 1, numCols+2);
+	}
+	else
+	{
+		for (int j=-1; j<=numCols; j++)
+		{
+			currentGrid2D[-1][j] = (frameBehavior == FRAME_RANDOM) ? rand() % 2 : 0;
+			currentGrid2D[numRows][j] = (frameBehavior == FRAME_RANDOM) ? rand() % 2 : 0;
+		}
+	}
+}
+
+/*
+ * Called by the front end:  the grid is reset with random values between
+ * two generations, while the compute threads are at the barrier.
+ */
+void requestReset(void)
+{
+	atomic_store(&resetRequested, true);
+}
+
+/*
+ * Selects the frame behavior by name (dead, wrap, clipped or random).  The
+ * change is applied between two generations.  Returns 0 on success, -1 if
+ * the name is unknown (or the engine is hashlife, which has no border).
+ */
+int setFrameBehavior(const char* name)
+{
+	for (int f=0; f<NB_FRAME_BEHAVIORS; f++)
+	{
+		size_t len = strlen(FRAME_BEHAVIOR_STR[f]);
+
+		//	the name may be followed by the end of line of a pipe command
+		if (strncmp(name, FRAME_BEHAVIOR_STR[f], len) == 0 &&
+			(name[len] == '\0' || name[len] == '\n' || name[len] == ' '))
+		{
+			if (engine == HASHLIFE_ENGINE && f != FRAME_DEAD)
+				return -1;
+
+			requestedFrameBehavior = (FrameBehavior) f;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Selects how a grid larger than the pane is drawn, by name (maxage or
+ * density), from the next frame on.  Returns 0 on success, -1 if the name
+ * is unknown.
+ */
+int setReductionMode(const char* name)
+{
+	for (int m=0; m<NB_REDUCTION_MODES; m++)
+	{
+		size_t len = strlen(REDUCTION_MODE_STR[m]);
+
+		//	the name may be followed by the end of line of a pipe command
+		if (strncmp(name, REDUCTION_MODE_STR[m], len) == 0 &&
+			(name[len] == '\0' || name[len] == '\n' || name[len] == ' '))
+		{
+			reductionMode = (ReductionMode) m;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+//	Switches to the next way of drawing a grid larger than the pane
+void cycleReductionMode(void)
+{
+	reductionMode = (ReductionMode) ((reductionMode + 1) % NB_REDUCTION_MODES);
+}
+
+//	Generations computed since the start, for the rate shown in the state pane
+double generationsComputed(void)
+{
+	return (double) generationCount;
+}
+
+/*
+ * True if a generation was published since the grid pane was last drawn.
+ * Otherwise the front end doesn't draw the window again (see myTimer).
+ */
+int gridChanged(void)
+{
+	return newFrameAvailable();
+}
+
+/*
+ * Makes the requested frame behavior the current one.  Only called when no
+ * generation is being computed (startup, or between two generations).
+ */
+void applyFrameBehavior(void)
+{
+	frameBehavior = requestedFrameBehavior;
+
+	if(useActiveTiles)
+	{
+		//	random borders change all the time, and on a torus the tiles
+		//	of opposite sides are neighbors
+		setBorderTilesAlwaysActive(frameBehavior == FRAME_RANDOM);
+		setTilesWrapAround(frameBehavior == FRAME_WRAP);
+		markAllTilesChanged();
+	}
 }
 
 //	This function swaps the current and next grids, as well as their
@@ -415,8 +1395,8 @@ void resetGrid(void)
 void swapGrids(void)
 {
 	//	swap grids
-	int* tempGrid;
-	int** tempGrid2D;
+	uint8_t* tempGrid;
+	uint8_t** tempGrid2D;
 	
 	tempGrid = currentGrid;
 	currentGrid = nextGrid;
@@ -427,6 +1407,44 @@ void swapGrids(void)
 	nextGrid2D = tempGrid2D;
 }
 
+/*
+ * Compiles the given rule (B/S string or preset number, see parseRule).  It
+ * becomes the current rule between two generations.  Returns 0 on success,
+ * -1 if the rule is invalid (in which case the current rule is not changed).
+ */
+int setRule(const char* ruleStr)
+{
+	RuleTable newRule;
+
+	if(parseRule(ruleStr, &newRule) != 0)
+		return -1;
+
+	//	nothing can be born from nothing on the unbounded plane of hashlife
+	if(engine == HASHLIFE_ENGINE && (newRule.birthMask & 1))
+		return -1;
+
+	pthread_mutex_lock(&ruleLock);
+	requestedRule = newRule;
+	atomic_store(&ruleRequested, true);
+	pthread_mutex_unlock(&ruleLock);
+	return 0;
+}
+
+/*
+ * Makes the requested rule the current one.  Only called when no generation
+ * is being computed (startup, or between two generations).
+ */
+void applyRule(void)
+{
+	pthread_mutex_lock(&ruleLock);
+	rule = requestedRule;
+	atomic_store(&ruleRequested, false);
+	pthread_mutex_unlock(&ruleLock);
+
+	if(useActiveTiles)
+		markAllTilesChanged();
+}
+
 /*
  * Function to generate a single generation of "cells"
  */
@@ -436,29 +1454,7 @@ void oneGeneration(void)
 	
 	for (int i=0; i<numRows; i++)
 	{
-		for (int j=0; j<numCols; j++)
-		{
-			unsigned int newState = cellNewState(i, j);
-
-			//	In black and white mode, only alive/dead matters
-			//	Dead is dead in any mode
-			if (colorMode == 0 || newState == 0)
-			{
-				nextGrid2D[i][j] = newState;
-			}
-			//	in color mode, color reflext the "age" of a live cell
-			else
-			{
-				//	Any cell that has not yet reached the "very old cell"
-				//	stage simply got one generation older
-				if (currentGrid2D[i][j] < NB_COLORS-1)
-					nextGrid2D[i][j] = currentGrid2D[i][j] + 1;
-				//	An old cell remains old until it dies
-				else
-					nextGrid2D[i][j] = currentGrid2D[i][j];
-
-			}
-		}
+		oneRowGeneration(i);
 	}
 	generation++;
 	
@@ -472,199 +1468,154 @@ void oneGeneration(void)
 void oneRowGeneration(int i)
 {
 	static int generation = 0;
-	for (int j=0; j<numCols; j++)
-		{
-			unsigned int newState = cellNewState(i, j);
 
-			//	In black and white mode, only alive/dead matters
-			//	Dead is dead in any mode
-			if (colorMode == 0 || newState == 0)
-			{
-				nextGrid2D[i][j] = newState;
-			}
-			//	in color mode, color reflext the "age" of a live cell
-			else
-			{
-				//	Any cell that has not yet reached the "very old cell"
-				//	stage simply got one generation older
-				if (currentGrid2D[i][j] < NB_COLORS-1)
-					nextGrid2D[i][j] = currentGrid2D[i][j] + 1;
-				//	An old cell remains old until it dies
-				else
-					nextGrid2D[i][j] = currentGrid2D[i][j];
-
-			}
-		}
+	oneRowSpanGeneration(i, 0, numCols);
 	generation++;
 }
 
-
-unsigned int cellNewState(unsigned int i, unsigned int j)
+/*
+ * This function generates the cells [startCol, endCol) of row i.
+ */
+void oneRowSpanGeneration(int i, int startCol, int endCol)
 {
-	//	First count the number of neighbors that are alive
-	//----------------------------------------------------
-	//	Again, this implementation makes no pretense at being the most efficient.
-	//	I am just trying to keep things modular and somewhat readable
-	int count = 0;
+	int j = startCol;
 
-	//	Away from the border, we simply count how many among the cell's
-	//	eight neighbors are alive (cell state > 0)
-	if (i>0 && i<numRows-1 && j>0 && j<numCols-1)
-	{
-		//	remember that in C, (x == val) is either 1 or 0
-		count = (currentGrid2D[i-1][j-1] != 0) +
-				(currentGrid2D[i-1][j] != 0) +
-				(currentGrid2D[i-1][j+1] != 0)  +
-				(currentGrid2D[i][j-1] != 0)  +
-				(currentGrid2D[i][j+1] != 0)  +
-				(currentGrid2D[i+1][j-1] != 0)  +
-				(currentGrid2D[i+1][j] != 0)  +
-				(currentGrid2D[i+1][j+1] != 0);
-	}
-	//	on the border of the frame...
-	else
+	//	Let the vector kernel do as much of the row as it can (the halo
+	//	gives it the neighbors of the first and last columns)
+	if (engine == SIMD_ENGINE && simdLevel != SIMD_NONE)
 	{
-		#if FRAME_BEHAVIOR == FRAME_DEAD
-		
-			//	Hack to force death of a cell
-			count = -1;
-		
-		#elif FRAME_BEHAVIOR == FRAME_RANDOM
-		
-			count = rand() % 9;
-		
-		#elif FRAME_BEHAVIOR == FRAME_CLIPPED
-	
-			if (i>0)
-			{
-				if (j>0 && currentGrid2D[i-1][j-1] != 0)
-					count++;
-				if (currentGrid2D[i-1][j] != 0)
-					count++;
-				if (j<numCols-1 && currentGrid2D[i-1][j+1] != 0)
-					count++;
-			}
+		j = simdRowGeneration(simdLevel, currentGrid2D[i-1], currentGrid2D[i], currentGrid2D[i+1],
+							  nextGrid2D[i], startCol, endCol,
+							  rule.birthMask, rule.surviveMask,
+							  colorMode, NB_COLORS-1);
+	}
 
-			if (j>0 && currentGrid2D[i][j-1] != 0)
-				count++;
-			if (j<numCols-1 && currentGrid2D[i][j+1] != 0)
-				count++;
+	for (; j<endCol; j++)
+	{
+		oneCellGeneration(i, j);
+	}
 
-			if (i<numRows-1)
-			{
-				if (j>0 && currentGrid2D[i+1][j-1] != 0)
-					count++;
-				if (currentGrid2D[i+1][j] != 0)
-					count++;
-				if (j<numCols-1 && currentGrid2D[i+1][j+1] != 0)
-					count++;
-			}
-			
-	
-		#elif FRAME_BEHAVIOR == FRAME_WRAPPED
-	
-			unsigned int 	iM1 = (i+numRows-1)%numRows,
-							iP1 = (i+1)%numRows,
-							jM1 = (j+numCols-1)%numCols,
-							jP1 = (j+1)%numCols;
-			count = currentGrid2D[iM1][jM1] != 0 +
-					currentGrid2D[iM1][j] != 0 +
-					currentGrid2D[iM1][jP1] != 0  +
-					currentGrid2D[i][jM1] != 0  +
-					currentGrid2D[i][jP1] != 0  +
-					currentGrid2D[iP1][jM1] != 0  +
-					currentGrid2D[iP1][j] != 0  +
-					currentGrid2D[iP1][jP1] != 0 ;
-
-		#else
-			#error undefined frame behavior
-		#endif
-		
-	}	//	end of else case (on border)
-	
-	//	Next apply the cellular automaton rule
-	//----------------------------------------------------
-	//	by default, the grid square is going to be empty/dead
-	unsigned int newState = 0;
-	
-	//	unless....
-	
-	switch (rule)
+	//	cells on the border are kept dead
+	if (frameBehavior == FRAME_DEAD)
 	{
-		//	Rule 1 (Conway's classical Game of Life: B3/S23)
-		case GAME_OF_LIFE_RULE:
+		if (i == 0 || i == numRows-1)
+			memset(nextGrid2D[i] + startCol, 0, endCol - startCol);
+		else
+		{
+			if (startCol == 0)
+				nextGrid2D[i][0] = 0;
+			if (endCol == numCols)
+				nextGrid2D[i][numCols-1] = 0;
+		}
+	}
+}
 
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count == 3 || count == 2)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 3)
-					newState = 1;
-			}
-			break;
-	
-		//	Rule 2 (Coral Growth: B3/S45678)
-		case CORAL_GROWTH_RULE:
+/*
+ * Computes the rows [startRow, endRow) one tile at a time, skipping the tiles
+ * whose neighborhood did not change during the last generation (their content
+ * in the next grid is already right, see activeTiles.h).
+ */
+void bandGeneration(int startRow, int endRow)
+{
+	for (int tileRow = startRow / TILE_SIZE; tileRow*TILE_SIZE < endRow; tileRow++)
+	{
+		//	part of the tile row that belongs to this band
+		int rowMin = tileRow*TILE_SIZE > startRow ? tileRow*TILE_SIZE : startRow;
+		int rowMax = (tileRow+1)*TILE_SIZE < endRow ? (tileRow+1)*TILE_SIZE : endRow;
 
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count > 3)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 3)
-					newState = 1;
-			}
-			break;
-			
-		//	Rule 3 (Amoeba: B357/S1358)
-		case AMOEBA_RULE:
+		for (unsigned int tileCol = 0; tileCol < getNumTileCols(); tileCol++)
+		{
+			if (tileIsActive(tileRow, tileCol) && oneTileGeneration(rowMin, rowMax, tileCol))
+				markTileChanged(tileRow, tileCol);
+		}
+	}
+}
 
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count == 1 || count == 3 || count == 5 || count == 8)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 1 || count == 3 || count == 5 || count == 8)
-					newState = 1;
-			}
-			break;
-		
-		//	Rule 4 (Maze: B3/S12345)							|
-		case MAZE_RULE:
+/*
+ * Computes the rows [startRow, endRow) of one column of tiles with the selected
+ * engine, and returns 1 if anything changed compared to the current generation.
+ */
+int oneTileGeneration(int startRow, int endRow, int tileCol)
+{
+	if (engine == BIT_PACKED_ENGINE)
+	{
+		int changed = bitGridTileGeneration(startRow, endRow,
+											tileCol*(TILE_SIZE/64), (tileCol+1)*(TILE_SIZE/64),
+											rule.birthMask, rule.surviveMask,
+											frameBehavior == FRAME_DEAD);
+		//	the rows are only told apart by the byte engines
+		if (changed)
+			setRowsChanged(startRow, endRow);
+		return changed;
+	}
 
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count >= 1 && count <= 5)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 3)
-					newState = 1;
-			}
-			break;
+	int startCol = tileCol*TILE_SIZE;
+	int endCol = startCol + TILE_SIZE < numCols ? startCol + TILE_SIZE : numCols;
+	int changed = 0;
 
-			break;
-		
-		default:
-			printf("Invalid rule number\n");
-			exit(5);
+	for (int i = startRow; i < endRow; i++)
+	{
+		oneRowSpanGeneration(i, startCol, endCol);
+		if (memcmp(nextGrid2D[i] + startCol, currentGrid2D[i] + startCol, endCol - startCol) != 0)
+		{
+			changed = 1;
+			setRowsChanged(i, i+1);
+		}
+	}
+	return changed;
+}
+
+/*
+ * This function generates one cell indexed by the given parameters.
+ */
+void oneCellGeneration(int i, int j)
+{
+	unsigned int newState = cellNewState(i, j);
+
+	//	In black and white mode, only alive/dead matters
+	//	Dead is dead in any mode
+	if (colorMode == 0 || newState == 0)
+	{
+		nextGrid2D[i][j] = newState;
 	}
+	//	in color mode, color reflext the "age" of a live cell
+	else
+	{
+		//	Any cell that has not yet reached the "very old cell"
+		//	stage simply got one generation older
+		if (currentGrid2D[i][j] < NB_COLORS-1)
+			nextGrid2D[i][j] = currentGrid2D[i][j] + 1;
+		//	An old cell remains old until it dies
+		else
+			nextGrid2D[i][j] = currentGrid2D[i][j];
 
-	return newState;
+	}
+}
+
+unsigned int cellNewState(int i, int j)
+{
+	//	First count the number of neighbors that are alive
+	//----------------------------------------------------
+	//	Again, this implementation makes no pretense at being the most efficient.
+	//	I am just trying to keep things modular and somewhat readable
+	int count = 0;
+
+	//	We simply count how many among the cell's eight neighbors are alive
+	//	(cell state > 0).  Cells on the border find their missing neighbors
+	//	in the halo, which holds what the frame behavior puts beyond the border.
+	//	remember that in C, (x == val) is either 1 or 0
+	count = (currentGrid2D[i-1][j-1] != 0) +
+			(currentGrid2D[i-1][j] != 0) +
+			(currentGrid2D[i-1][j+1] != 0)  +
+			(currentGrid2D[i][j-1] != 0)  +
+			(currentGrid2D[i][j+1] != 0)  +
+			(currentGrid2D[i+1][j-1] != 0)  +
+			(currentGrid2D[i+1][j] != 0)  +
+			(currentGrid2D[i+1][j+1] != 0);
+	
+	//	Next apply the cellular automaton rule
+	//----------------------------------------------------
+	//	The rule was compiled into a table of the next state for every
+	//	(alive, neighbor count) pair, so there is nothing left to test.
+	return rule.newState[currentGrid2D[i][j] != 0][count];
 }
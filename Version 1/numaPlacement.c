@@ -0,0 +1,106 @@
+//
+//  numaPlacement.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+//
+#include "numaPlacement.h"
+
+
+/*
+ * Pins the calling thread to the threadIndex-th CPU the process is allowed
+ * to run on (wrapping around if there are more threads than CPUs).
+ * Returns the CPU number, or -1 on failure.
+ */
+int pinThreadToCpu(unsigned int threadIndex)
+{
+	cpu_set_t allowed, mine;
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		return -1;
+
+	int numAllowed = CPU_COUNT(&allowed);
+	if (numAllowed == 0)
+		return -1;
+
+	//	find the (threadIndex % numAllowed)-th CPU of the set
+	int rank = (int) (threadIndex % (unsigned int) numAllowed);
+	for (int cpu=0; cpu<CPU_SETSIZE; cpu++)
+	{
+		if (CPU_ISSET(cpu, &allowed) && rank-- == 0)
+		{
+			CPU_ZERO(&mine);
+			CPU_SET(cpu, &mine);
+			if (pthread_setaffinity_np(pthread_self(), sizeof(mine), &mine) != 0)
+				return -1;
+			return cpu;
+		}
+	}
+	return -1;
+}
+
+//	CPU and NUMA node the calling thread is running on right now (-1 if unknown)
+void getCpuAndNode(int* cpu, int* node)
+{
+	unsigned int c, n;
+
+	if (syscall(SYS_getcpu, &c, &n, NULL) == 0)
+	{
+		*cpu = (int) c;
+		*node = (int) n;
+	}
+	else
+	{
+		*cpu = *node = -1;
+	}
+}
+
+/*
+ * Counts on which node the pages of the given memory range live.
+ * pageCount[n] gets the number of pages on node n, pageCount[MAX_NUMA_NODES]
+ * the pages on a higher node, not yet allocated, or that could not be queried.
+ */
+void countPagesPerNode(const void* start, size_t length,
+					   unsigned int pageCount[MAX_NUMA_NODES + 1])
+{
+	const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+	const uintptr_t first = (uintptr_t) start & ~(pageSize - 1);
+	const size_t numPages = ((uintptr_t) start + length - first + pageSize - 1) / pageSize;
+
+	memset(pageCount, 0, (MAX_NUMA_NODES + 1)*sizeof(unsigned int));
+	if (length == 0)
+		return;
+
+	void** pages = (void**) malloc(numPages*sizeof(void*));
+	int* status = (int*) malloc(numPages*sizeof(int));
+	for (size_t p=0; p<numPages; p++)
+		pages[p] = (void*) (first + p*pageSize);
+
+	//	move_pages with no target nodes only reports where each page is
+	if (syscall(SYS_move_pages, 0, numPages, pages, NULL, status, 0) != 0)
+	{
+		for (size_t p=0; p<numPages; p++)
+			status[p] = -1;
+	}
+
+	for (size_t p=0; p<numPages; p++)
+	{
+		if (status[p] >= 0 && status[p] < MAX_NUMA_NODES)
+			pageCount[status[p]]++;
+		else
+			pageCount[MAX_NUMA_NODES]++;
+	}
+
+	free(pages);
+	free(status);
+}
@@ -0,0 +1,33 @@
+//
+//  numaPlacement.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef NUMA_PLACEMENT_H
+#define NUMA_PLACEMENT_H
+
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+//	Helpers to keep each compute thread close to its rows on NUMA machines.
+//	Linux places a page on the node of the thread that first writes to it,
+//	so the threads zero their own rows themselves before the grid is filled
+//	("first touch"), optionally after being pinned to one CPU each.
+//	The queries go straight to the system calls, so there is no dependency
+//	on libnuma; on a kernel without NUMA support the pages are counted as
+//	unknown.
+//-----------------------------------------------------------------------------
+
+//	Larger node numbers are reported as "other"
+#define MAX_NUMA_NODES	16
+
+int pinThreadToCpu(unsigned int threadIndex);
+void getCpuAndNode(int* cpu, int* node);
+
+void countPagesPerNode(const void* start, size_t length,
+					   unsigned int pageCount[MAX_NUMA_NODES + 1]);
+
+
+#endif // NUMA_PLACEMENT_H
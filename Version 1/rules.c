@@ -0,0 +1,150 @@
+//
+//  rules.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <ctype.h>
+#include <string.h>
+//
+#include "rules.h"
+
+//---------------------------------------------------------------------------
+//  The hard-coded rules that can still be selected by number
+//---------------------------------------------------------------------------
+
+#define NB_PRESET_RULES		4
+
+static const char* PRESET_RULE_STR[NB_PRESET_RULES+1] = {
+										NULL,
+										"B3/S23",		//	GAME_OF_LIFE_RULE
+										"B3/S45678",	//	CORAL_GROWTH_RULE
+										"B357/S1358",	//	AMOEBA_RULE
+										"B3/S12345"		//	MAZE_RULE
+};
+
+static const char* PRESET_RULE_NAME[NB_PRESET_RULES+1] = {
+										NULL,
+										"Game of Life",
+										"Coral",
+										"Amoeba",
+										"Maze"
+};
+
+
+const char* presetRuleName(unsigned int number)
+{
+	if (number >= 1 && number <= NB_PRESET_RULES)
+		return PRESET_RULE_NAME[number];
+
+	return NULL;
+}
+
+/*
+ * Fills in the lookup table and the canonical string of the rule defined
+ * by the birth and survival masks.
+ */
+void buildRuleTable(unsigned int birthMask, unsigned int surviveMask, RuleTable* table)
+{
+	char* p = table->str;
+
+	table->birthMask = birthMask;
+	table->surviveMask = surviveMask;
+
+	*p++ = 'B';
+	for (unsigned int k=0; k<=8; k++)
+	{
+		table->newState[0][k] = (birthMask >> k) & 1;
+		if (table->newState[0][k])
+			*p++ = (char) ('0' + k);
+	}
+	*p++ = '/';
+	*p++ = 'S';
+	for (unsigned int k=0; k<=8; k++)
+	{
+		table->newState[1][k] = (surviveMask >> k) & 1;
+		if (table->newState[1][k])
+			*p++ = (char) ('0' + k);
+	}
+	*p = '\0';
+
+	//	Remember if this is one of the presets, so that the front end can
+	//	display its name
+	table->number = 0;
+	for (unsigned int n=1; n<=NB_PRESET_RULES; n++)
+	{
+		if (strcmp(table->str, PRESET_RULE_STR[n]) == 0)
+			table->number = n;
+	}
+}
+
+//	Reads one half of a rule string (up to '/' or the end) into a mask of
+//	neighbor counts.  Returns a pointer past what was read, or NULL if the
+//	half contains anything but the digits 0-8.
+static const char* parseRuleHalf(const char* p, unsigned int* mask)
+{
+	*mask = 0;
+	while (*p != '\0' && *p != '/' && !isspace((unsigned char) *p))
+	{
+		if (*p < '0' || *p > '8')
+			return NULL;
+		*mask |= 1u << (*p - '0');
+		p++;
+	}
+	return p;
+}
+
+/*
+ * Compiles a rule into the table.  Accepted forms:
+ *		- a preset number:			"1" ... "4"
+ *		- B/S notation:				"B36/S23", "b3/s23", "S23/B3"
+ *		- the older S/B notation:	"23/3"
+ * Leading and trailing white space (e.g. the '\n' read from the pipe) is
+ * ignored.  Returns 0 on success, -1 if the string is not a valid rule.
+ */
+int parseRule(const char* ruleStr, RuleTable* table)
+{
+	const char* p = ruleStr;
+	unsigned int masks[2];
+	int letter[2];
+
+	while (isspace((unsigned char) *p))
+		p++;
+
+	//	Preset number
+	if (p[0] >= '1' && p[0] < '1' + NB_PRESET_RULES &&
+		(p[1] == '\0' || isspace((unsigned char) p[1])))
+	{
+		return parseRule(PRESET_RULE_STR[p[0] - '0'], table);
+	}
+
+	//	Two halves separated by a '/', each with an optional B or S prefix
+	for (int h=0; h<2; h++)
+	{
+		letter[h] = toupper((unsigned char) *p);
+		if (letter[h] == 'B' || letter[h] == 'S')
+			p++;
+		else
+			letter[h] = 0;
+
+		p = parseRuleHalf(p, &masks[h]);
+		if (p == NULL || (h == 0 && *p++ != '/'))
+			return -1;
+	}
+	while (isspace((unsigned char) *p))
+		p++;
+	if (*p != '\0')
+		return -1;
+
+	if (letter[0] == 0 && letter[1] == 0)
+		buildRuleTable(masks[1], masks[0], table);				//	"S/B"
+	else if (letter[0] == 'B' && letter[1] == 'S')
+		buildRuleTable(masks[0], masks[1], table);
+	else if (letter[0] == 'S' && letter[1] == 'B')
+		buildRuleTable(masks[1], masks[0], table);
+	else
+		return -1;
+
+	return 0;
+}
@@ -0,0 +1,42 @@
+//
+//  rules.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef RULES_H
+#define RULES_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+//	Outer-totalistic ("B/S") rules.  A rule string such as "B36/S23" says
+//	that a dead cell with 3 or 6 live neighbors is born and a live cell with
+//	2 or 3 live neighbors survives.  The string is compiled into a table of
+//	the next state for every (alive, neighbor count) pair, so that applying
+//	the rule in the hot loop is a single lookup.
+//-----------------------------------------------------------------------------
+
+//	"B012345678/S012345678" + '\0'
+#define RULE_STR_LENGTH		24
+
+typedef struct RuleTable
+{
+	//	bit k set: a dead (live) cell with k live neighbors is alive next
+	unsigned int	birthMask;
+	unsigned int	surviveMask;
+	//	newState[alive][count] is 0 or 1
+	uint8_t			newState[2][9];
+	//	preset number (GAME_OF_LIFE_RULE...) if the rule is one of them, else 0
+	unsigned int	number;
+	//	canonical B/S string
+	char			str[RULE_STR_LENGTH];
+} RuleTable;
+
+void buildRuleTable(unsigned int birthMask, unsigned int surviveMask, RuleTable* table);
+int parseRule(const char* ruleStr, RuleTable* table);
+const char* presetRuleName(unsigned int number);
+
+
+#endif // RULES_H
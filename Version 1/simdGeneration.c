@@ -0,0 +1,174 @@
+//
+//  simdGeneration.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include "simdGeneration.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define HAS_X86_SIMD	1
+#else
+	#define HAS_X86_SIMD	0
+#endif
+
+
+SimdLevel detectSimdLevel(void)
+{
+	#if HAS_X86_SIMD
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return SIMD_AVX2;
+		if (__builtin_cpu_supports("sse2"))
+			return SIMD_SSE2;
+	#endif
+
+	return SIMD_NONE;
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+		case SIMD_AVX2:
+			return "AVX2";
+		case SIMD_SSE2:
+			return "SSE2";
+		default:
+			return "none";
+	}
+}
+
+#if HAS_X86_SIMD
+
+//	Both kernels follow the same steps as cellNewState + oneRowGeneration:
+//		1. alive = min(cell, 1) for the eight neighbors, summed into a count
+//		2. compare the count against every k in the birth/survive masks
+//		3. live cells use the survive result, dead cells the birth result
+//		4. in color mode a cell that stays alive gets one generation older
+//	They handle the columns startCol .. endCol-1 and return the first column
+//	they did not compute.
+
+__attribute__((target("avx2")))
+static unsigned int avx2RowGeneration(const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+									  uint8_t* out, unsigned int startCol, unsigned int endCol,
+									  unsigned int birthMask, unsigned int surviveMask,
+									  unsigned int colorMode, uint8_t oldestAge)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i oldest = _mm256_set1_epi8((char) oldestAge);
+	unsigned int j = startCol;
+
+	#define ALIVE_256(p)	_mm256_min_epu8(_mm256_loadu_si256((const __m256i*) (p)), one)
+
+	for (; j + 32 <= endCol; j += 32)
+	{
+		__m256i count = _mm256_add_epi8(_mm256_add_epi8(ALIVE_256(up + j-1), ALIVE_256(up + j)),
+										_mm256_add_epi8(ALIVE_256(up + j+1), ALIVE_256(mid + j-1)));
+		count = _mm256_add_epi8(count,
+					_mm256_add_epi8(_mm256_add_epi8(ALIVE_256(mid + j+1), ALIVE_256(down + j-1)),
+									_mm256_add_epi8(ALIVE_256(down + j), ALIVE_256(down + j+1))));
+
+		__m256i born = zero, keep = zero;
+		for (unsigned int k=0; k<=8; k++)
+		{
+			if (((birthMask | surviveMask) >> k) & 1)
+			{
+				__m256i eq = _mm256_cmpeq_epi8(count, _mm256_set1_epi8((char) k));
+				if ((birthMask >> k) & 1)
+					born = _mm256_or_si256(born, eq);
+				if ((surviveMask >> k) & 1)
+					keep = _mm256_or_si256(keep, eq);
+			}
+		}
+
+		__m256i cell = _mm256_loadu_si256((const __m256i*) (mid + j));
+		__m256i isDead = _mm256_cmpeq_epi8(cell, zero);
+		__m256i newAlive = _mm256_or_si256(_mm256_and_si256(isDead, born),
+										   _mm256_andnot_si256(isDead, keep));
+		__m256i value = colorMode ? _mm256_min_epu8(_mm256_add_epi8(cell, one), oldest) : one;
+
+		_mm256_storeu_si256((__m256i*) (out + j), _mm256_and_si256(newAlive, value));
+	}
+
+	#undef ALIVE_256
+
+	return j;
+}
+
+static unsigned int sse2RowGeneration(const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+									  uint8_t* out, unsigned int startCol, unsigned int endCol,
+									  unsigned int birthMask, unsigned int surviveMask,
+									  unsigned int colorMode, uint8_t oldestAge)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i oldest = _mm_set1_epi8((char) oldestAge);
+	unsigned int j = startCol;
+
+	#define ALIVE_128(p)	_mm_min_epu8(_mm_loadu_si128((const __m128i*) (p)), one)
+
+	for (; j + 16 <= endCol; j += 16)
+	{
+		__m128i count = _mm_add_epi8(_mm_add_epi8(ALIVE_128(up + j-1), ALIVE_128(up + j)),
+									 _mm_add_epi8(ALIVE_128(up + j+1), ALIVE_128(mid + j-1)));
+		count = _mm_add_epi8(count,
+					_mm_add_epi8(_mm_add_epi8(ALIVE_128(mid + j+1), ALIVE_128(down + j-1)),
+								 _mm_add_epi8(ALIVE_128(down + j), ALIVE_128(down + j+1))));
+
+		__m128i born = zero, keep = zero;
+		for (unsigned int k=0; k<=8; k++)
+		{
+			if (((birthMask | surviveMask) >> k) & 1)
+			{
+				__m128i eq = _mm_cmpeq_epi8(count, _mm_set1_epi8((char) k));
+				if ((birthMask >> k) & 1)
+					born = _mm_or_si128(born, eq);
+				if ((surviveMask >> k) & 1)
+					keep = _mm_or_si128(keep, eq);
+			}
+		}
+
+		__m128i cell = _mm_loadu_si128((const __m128i*) (mid + j));
+		__m128i isDead = _mm_cmpeq_epi8(cell, zero);
+		__m128i newAlive = _mm_or_si128(_mm_and_si128(isDead, born),
+										_mm_andnot_si128(isDead, keep));
+		__m128i value = colorMode ? _mm_min_epu8(_mm_add_epi8(cell, one), oldest) : one;
+
+		_mm_storeu_si128((__m128i*) (out + j), _mm_and_si128(newAlive, value));
+	}
+
+	#undef ALIVE_128
+
+	return j;
+}
+
+#endif // HAS_X86_SIMD
+
+/*
+ * Computes as many cells of row "mid" in [startCol, endCol) as the selected
+ * instruction set can, and returns the first column left for the scalar code.
+ * up/mid/down are the rows i-1, i, i+1 of the current grid, out is row i of
+ * the next grid.  Column startCol-1 and endCol are read:  at the left and
+ * right borders of the grid, these are the halo cells.
+ */
+unsigned int simdRowGeneration(SimdLevel level,
+							   const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+							   uint8_t* out, unsigned int startCol, unsigned int endCol,
+							   unsigned int birthMask, unsigned int surviveMask,
+							   unsigned int colorMode, uint8_t oldestAge)
+{
+	#if HAS_X86_SIMD
+		if (level == SIMD_AVX2)
+			return avx2RowGeneration(up, mid, down, out, startCol, endCol, birthMask, surviveMask,
+									 colorMode, oldestAge);
+		if (level == SIMD_SSE2)
+			return sse2RowGeneration(up, mid, down, out, startCol, endCol, birthMask, surviveMask,
+									 colorMode, oldestAge);
+	#endif
+
+	return startCol;
+}
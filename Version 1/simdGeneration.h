@@ -0,0 +1,38 @@
+//
+//  simdGeneration.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef SIMD_GENERATION_H
+#define SIMD_GENERATION_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+//	Vectorized version of oneRowGeneration for the byte grid:  the eight
+//	neighbors of 32 (AVX2) or 16 (SSE2) cells are counted at once and the
+//	rule is applied with SIMD compares.  The instruction set is picked at
+//	run time from CPUID; SIMD_NONE means the caller has to fall back on
+//	cellNewState.
+//-----------------------------------------------------------------------------
+
+typedef enum SimdLevel
+{
+	SIMD_NONE = 0,
+	SIMD_SSE2,
+	SIMD_AVX2
+} SimdLevel;
+
+SimdLevel detectSimdLevel(void);
+const char* simdLevelName(SimdLevel level);
+
+unsigned int simdRowGeneration(SimdLevel level,
+							   const uint8_t* up, const uint8_t* mid, const uint8_t* down,
+							   uint8_t* out, unsigned int startCol, unsigned int endCol,
+							   unsigned int birthMask, unsigned int surviveMask,
+							   unsigned int colorMode, uint8_t oldestAge);
+
+
+#endif // SIMD_GENERATION_H
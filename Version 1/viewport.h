@@ -0,0 +1,43 @@
+//
+//  viewport.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef VIEWPORT_H
+#define VIEWPORT_H
+
+//-----------------------------------------------------------------------------
+//	The part of the grid shown in the grid pane:  numRows x numCols cells
+//	from (firstRow, firstCol), drawn over the whole pane.  It starts as the
+//	whole grid.  Zooming in by a factor divides both of its dimensions by it
+//	(so the cells keep the same aspect ratio), and panning moves it, always
+//	within the grid.  Only the cells of the viewport are copied for the
+//	renderer and drawn.
+//	The front end changes it (mouse, keyboard and pipe commands) while the
+//	frames are made from it, so it is kept behind a lock:  getViewport gives
+//	a copy that stays consistent for a whole frame.
+//-----------------------------------------------------------------------------
+
+typedef struct Viewport
+{
+	unsigned int	firstRow, firstCol;
+	unsigned int	numRows, numCols;
+} Viewport;
+
+//	a viewport is never smaller than this many cells in each dimension
+#define MIN_VIEWPORT_CELLS	4
+
+void initializeViewport(unsigned int gridRows, unsigned int gridCols);
+
+void getViewport(Viewport* view);
+double getViewportZoom(void);
+
+void resetViewport(void);
+void zoomViewport(double factor, double anchorRow, double anchorCol);
+void panViewport(double numRows, double numCols);
+void centerViewport(double centerRow, double centerCol, double zoom);
+
+
+#endif // VIEWPORT_H
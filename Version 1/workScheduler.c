@@ -0,0 +1,122 @@
+//
+//  workScheduler.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+//
+#include "workScheduler.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+//	A deque holds the blocks [front, back) of its thread's share.  Both ends
+//	are packed into one word (front in the low half, back in the high half)
+//	so that the owner and the thieves can update it with a single CAS.
+//	Each deque gets its own cache line so the threads don't fight over it.
+typedef struct BlockDeque
+{
+	_Atomic uint64_t	range;
+	char				padding[64 - sizeof(uint64_t)];
+} BlockDeque;
+
+static BlockDeque* deques;
+
+static unsigned int numDeques, numBlocksTotal;
+
+#define PACK_RANGE(front, back)		(((uint64_t) (back) << 32) | (uint32_t) (front))
+#define RANGE_FRONT(range)			((uint32_t) (range))
+#define RANGE_BACK(range)			((uint32_t) ((range) >> 32))
+
+
+void initializeScheduler(unsigned int numThreads, unsigned int numBlocks)
+{
+	numDeques = numThreads;
+	numBlocksTotal = numBlocks;
+	deques = (BlockDeque*) aligned_alloc(64, numThreads*sizeof(BlockDeque));
+	resetScheduler();
+}
+
+void freeScheduler(void)
+{
+	free(deques);
+}
+
+/*
+ * Blocks [firstBlock, lastBlock) are the share a thread starts every
+ * generation with (its "home" blocks, unless they get stolen)
+ */
+void getHomeBlocks(unsigned int threadIndex, unsigned int* firstBlock, unsigned int* lastBlock)
+{
+	*firstBlock = (unsigned int) ((uint64_t) threadIndex*numBlocksTotal / numDeques);
+	*lastBlock = (unsigned int) ((uint64_t) (threadIndex+1)*numBlocksTotal / numDeques);
+}
+
+/*
+ * Gives every thread its own share of the blocks back, for a new generation.
+ * Must be called when no thread is looking for work (between generations).
+ */
+void resetScheduler(void)
+{
+	for (unsigned int t=0; t<numDeques; t++)
+	{
+		unsigned int front, back;
+		getHomeBlocks(t, &front, &back);
+		atomic_store(&deques[t].range, PACK_RANGE(front, back));
+	}
+}
+
+//	Takes the first block of a deque, or returns -1 if it is empty
+static int popFront(BlockDeque* deque)
+{
+	uint64_t range = atomic_load(&deque->range);
+
+	while (RANGE_FRONT(range) < RANGE_BACK(range))
+	{
+		if (atomic_compare_exchange_weak(&deque->range, &range,
+										 PACK_RANGE(RANGE_FRONT(range)+1, RANGE_BACK(range))))
+			return (int) RANGE_FRONT(range);
+	}
+	return -1;
+}
+
+//	Takes the last block of a deque, or returns -1 if it is empty
+static int popBack(BlockDeque* deque)
+{
+	uint64_t range = atomic_load(&deque->range);
+
+	while (RANGE_FRONT(range) < RANGE_BACK(range))
+	{
+		if (atomic_compare_exchange_weak(&deque->range, &range,
+										 PACK_RANGE(RANGE_FRONT(range), RANGE_BACK(range)-1)))
+			return (int) RANGE_BACK(range) - 1;
+	}
+	return -1;
+}
+
+/*
+ * Returns the next block the given thread should compute, or -1 when all
+ * the blocks of the generation have been handed out.
+ */
+int nextBlock(unsigned int threadIndex)
+{
+	int block = popFront(&deques[threadIndex]);
+	if (block >= 0)
+		return block;
+
+	//	Own share done:  go steal from the others, starting with the next
+	//	thread.  No block is ever added during a generation, so once every
+	//	deque has been found empty, there is nothing left to do.
+	for (unsigned int k=1; k<numDeques; k++)
+	{
+		block = popBack(&deques[(threadIndex + k) % numDeques]);
+		if (block >= 0)
+			return block;
+	}
+	return -1;
+}
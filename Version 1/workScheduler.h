@@ -0,0 +1,28 @@
+//
+//  workScheduler.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef WORK_SCHEDULER_H
+#define WORK_SCHEDULER_H
+
+//-----------------------------------------------------------------------------
+//	Work-stealing scheduler for the compute threads.  A generation is cut
+//	into numBlocks blocks of work, and every thread starts the generation
+//	with its own contiguous share of them in a deque.  A thread takes
+//	blocks from the front of its own deque, and once it is empty, steals
+//	blocks from the back of the other threads' deques, so that the threads
+//	with the cheap blocks (static areas, fewer live cells) help the others.
+//-----------------------------------------------------------------------------
+
+void initializeScheduler(unsigned int numThreads, unsigned int numBlocks);
+void freeScheduler(void);
+
+void getHomeBlocks(unsigned int threadIndex, unsigned int* firstBlock, unsigned int* lastBlock);
+void resetScheduler(void);
+int nextBlock(unsigned int threadIndex);
+
+
+#endif // WORK_SCHEDULER_H
@@ -0,0 +1,95 @@
+//
+//  frameStats.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+#include <string.h>
+//
+#include "frameStats.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+//	start and duration of the last frames drawn, in a ring
+static double frameStarts[FRAME_STATS_WINDOW], frameTimes[FRAME_STATS_WINDOW];
+static unsigned int numFrames = 0, nextFrame = 0;
+
+//	generations computed at the last sample, and the rate measured then
+static double sampleTime = 0.0, sampleGenerations = 0.0;
+static double generationRate = 0.0;
+
+
+//	Records a frame that started drawing at startTime and took frameTime seconds
+void recordFrame(double startTime, double frameTime)
+{
+	frameStarts[nextFrame] = startTime;
+	frameTimes[nextFrame] = frameTime;
+	nextFrame = (nextFrame + 1) % FRAME_STATS_WINDOW;
+	if (numFrames < FRAME_STATS_WINDOW)
+		numFrames++;
+}
+
+static int compareTimes(const void* a, const void* b)
+{
+	double ta = *(const double*) a, tb = *(const double*) b;
+	return (ta > tb) - (ta < tb);
+}
+
+//	Nearest rank percentile of n sorted times
+static double percentile(const double* sortedTimes, unsigned int n, double percent)
+{
+	double exactRank = percent / 100.0 * n;
+	unsigned int rank = (unsigned int) exactRank;
+	if (rank < exactRank)
+		rank++;
+	if (rank < 1)
+		rank = 1;
+	return sortedTimes[rank - 1];
+}
+
+/*
+ * Fills stats as of now (a time of the same clock as the frames), given the
+ * number of generations computed so far.  The rate of generations is
+ * measured again once FRAME_STATS_PERIOD has elapsed since the last time.
+ */
+void getFrameStats(double now, double generations, FrameStats* stats)
+{
+	if (now - sampleTime >= FRAME_STATS_PERIOD)
+	{
+		//	a reset may start the count over
+		generationRate = (sampleTime > 0.0 && generations >= sampleGenerations) ?
+							(generations - sampleGenerations) / (now - sampleTime) : 0.0;
+		sampleTime = now;
+		sampleGenerations = generations;
+	}
+	stats->generationsPerSecond = generationRate;
+
+	//	frames started within the last period, or within the window if it
+	//	doesn't reach that far back
+	double span = FRAME_STATS_PERIOD;
+	unsigned int numRecent = 0;
+	for (unsigned int f=0; f<numFrames; f++)
+	{
+		if (frameStarts[f] > now - FRAME_STATS_PERIOD)
+			numRecent++;
+	}
+	if (numFrames == FRAME_STATS_WINDOW && numRecent == numFrames && now > frameStarts[nextFrame])
+		span = now - frameStarts[nextFrame];
+	stats->renderFps = numRecent / span;
+
+	if (numFrames == 0)
+	{
+		stats->frameTimeP50 = stats->frameTimeP95 = stats->frameTimeP99 = 0.0;
+		return;
+	}
+	double sortedTimes[FRAME_STATS_WINDOW];
+	memcpy(sortedTimes, frameTimes, numFrames*sizeof(double));
+	qsort(sortedTimes, numFrames, sizeof(double), compareTimes);
+	stats->frameTimeP50 = percentile(sortedTimes, numFrames, 50.0);
+	stats->frameTimeP95 = percentile(sortedTimes, numFrames, 95.0);
+	stats->frameTimeP99 = percentile(sortedTimes, numFrames, 99.0);
+}
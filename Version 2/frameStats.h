@@ -0,0 +1,34 @@
+//
+//  frameStats.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+//-----------------------------------------------------------------------------
+//	Measures of the render loop, for the state pane:  the rate at which
+//	frames are actually drawn, how long drawing one takes (percentiles over
+//	the last FRAME_STATS_WINDOW frames), and the rate at which generations
+//	are computed, over about FRAME_STATS_PERIOD seconds.  A frame time close
+//	to the period of the target rate means the display is what holds things
+//	back.  Only the glut thread uses this module, so it needs no lock.
+//-----------------------------------------------------------------------------
+
+#define FRAME_STATS_WINDOW	240
+#define FRAME_STATS_PERIOD	1.0
+
+typedef struct FrameStats
+{
+	double	renderFps;				//	frames drawn per second
+	double	generationsPerSecond;
+	double	frameTimeP50, frameTimeP95, frameTimeP99;	//	in seconds
+} FrameStats;
+
+void recordFrame(double startTime, double frameTime);
+void getFrameStats(double now, double generations, FrameStats* stats);
+
+
+#endif // FRAME_STATS_H
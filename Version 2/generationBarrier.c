@@ -0,0 +1,54 @@
+//
+//  generationBarrier.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include "generationBarrier.h"
+
+
+void initializeBarrier(GenerationBarrier* barrier, unsigned int numThreads)
+{
+	pthread_mutex_init(&barrier->lock, NULL);
+	pthread_cond_init(&barrier->released, NULL);
+	barrier->numThreads = numThreads;
+	barrier->numArrived = 0;
+	barrier->generation = 0;
+}
+
+void destroyBarrier(GenerationBarrier* barrier)
+{
+	pthread_cond_destroy(&barrier->released);
+	pthread_mutex_destroy(&barrier->lock);
+}
+
+/*
+ * Blocks until all the threads have called barrierWait for the current
+ * generation.  The last thread to arrive calls lastArrivalFunc (if not NULL)
+ * before anybody is released, and is the only one to get true back.
+ */
+bool barrierWait(GenerationBarrier* barrier, void (*lastArrivalFunc)(void))
+{
+	pthread_mutex_lock(&barrier->lock);
+
+	if (++barrier->numArrived == barrier->numThreads)
+	{
+		if (lastArrivalFunc != NULL)
+			lastArrivalFunc();
+
+		barrier->numArrived = 0;
+		barrier->generation++;
+		pthread_cond_broadcast(&barrier->released);
+		pthread_mutex_unlock(&barrier->lock);
+		return true;
+	}
+
+	//	wait for the generation counter to move (guards against spurious wakeups)
+	unsigned long myGeneration = barrier->generation;
+	while (barrier->generation == myGeneration)
+		pthread_cond_wait(&barrier->released, &barrier->lock);
+
+	pthread_mutex_unlock(&barrier->lock);
+	return false;
+}
@@ -0,0 +1,38 @@
+//
+//  generationBarrier.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef GENERATION_BARRIER_H
+#define GENERATION_BARRIER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+//-----------------------------------------------------------------------------
+//	Reusable barrier for the compute threads.  Every thread calls
+//	barrierWait once it is done with its part of a generation.  The last
+//	one to arrive runs the end-of-generation function (grid swap, etc.)
+//	while all the others are still blocked, then releases everybody for the
+//	next generation.  The same barrier is used for every generation.
+//-----------------------------------------------------------------------------
+
+typedef struct GenerationBarrier
+{
+	pthread_mutex_t		lock;
+	pthread_cond_t		released;
+	unsigned int		numThreads;
+	unsigned int		numArrived;
+	//	incremented every time the barrier opens
+	unsigned long		generation;
+} GenerationBarrier;
+
+void initializeBarrier(GenerationBarrier* barrier, unsigned int numThreads);
+void destroyBarrier(GenerationBarrier* barrier);
+
+bool barrierWait(GenerationBarrier* barrier, void (*lastArrivalFunc)(void));
+
+
+#endif // GENERATION_BARRIER_H
@@ -8,6 +8,13 @@
 #ifndef GL_FRONT_END_H
 #define GL_FRONT_END_H
 
+#include <stdint.h>
+//
+#include "rules.h"
+#include "viewport.h"
+#include "frameStats.h"
+#include "rateControl.h"
+#include "updateStats.h"
 
 //------------------------------------------------------------------------------
 //	Find out whether we are on Linux or macOS (sorry, Windows people)
@@ -47,29 +54,47 @@ typedef enum ColorLabel {
 	NB_COLORS
 } ColorLabel;
 
-//	Rules of the automaton (in C, it's a lot more complicated than in
-//	C++/Java/Python/Swift to define an easy-to-initialize data type storing
-//	arrays of numbers.  So, in this program I hard-code my rules
+//	Preset rules of the automaton, selected by number.  Any other B/S rule
+//	can be given as a string (see rules.h)
 #define GAME_OF_LIFE_RULE	1
 #define CORAL_GROWTH_RULE	2
 #define AMOEBA_RULE			3
 #define MAZE_RULE			4
 
 
+//	Frames per second the display aims at, unless told otherwise (--fps)
+#define DEFAULT_TARGET_FPS	60
+#define MAX_TARGET_FPS		1000
+
 //-----------------------------------------------------------------------------
 //	Function prototypes
 //-----------------------------------------------------------------------------
 
-void drawGrid(int**grid, unsigned int numRows, unsigned int numCols);
+void drawGrid(int**grid, unsigned int numRows, unsigned int numCols, const uint8_t* changedRows);
+void drawReducedGrid(uint8_t** image, unsigned int imageRows, unsigned int imageCols, int isDensity,
+					 const uint8_t* changedRows);
 void drawState(unsigned int numLiveThreads, int maxThreadCount);
-void drawRule(int currentRule);
-void drawSleepTimer(void);
+void drawRule(const RuleTable* currentRule);
+void drawUpdateRate(unsigned int numCells);
+void drawUpdateStats(const UpdateStats* stats);
+void drawRenderMode(const char* modeName, const Viewport* view, double zoom);
+void drawFrameStats(void);
 void drawTitle(void);
 void initializeFrontEnd(int argc, char** argv, void (*gridCB)(void), void (*stateCB)(void));
 void commandHandler(char* cmd);
+int setTargetFps(double fps);
 
 //	Functions implemented in main.c but called byt the glut callback functions
 void resetGrid(void);
+int setRule(const char* ruleStr);
+int setReductionMode(const char* name);
+int gridChanged(void);
+double generationsComputed(void);
+double wallClockTime(void);
+void cycleReductionMode(void);
+void setSeed(uint64_t seed);
+void setSweepRate(double sweepsPerSecond);
+void printUpdateStats(void);
 void oneGeneration(void);
 
 
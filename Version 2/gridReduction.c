@@ -0,0 +1,56 @@
+//
+//  gridReduction.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include "gridReduction.h"
+
+//	as given to the pipe command "render"
+const char* REDUCTION_MODE_STR[NB_REDUCTION_MODES] = {"maxage", "density"};
+
+
+//	An image of the size of the grid, clipped to maxRows x maxCols
+void reducedSize(unsigned int numRows, unsigned int numCols, unsigned int maxRows, unsigned int maxCols,
+				 unsigned int* imageRows, unsigned int* imageCols)
+{
+	*imageRows = (numRows < maxRows) ? numRows : maxRows;
+	*imageCols = (numCols < maxCols) ? numCols : maxCols;
+}
+
+/*
+ * Computes one row of the image, from the numBlockRows rows of cells it
+ * stands for (rows[0] .. rows[numBlockRows-1]), of which the numCols
+ * columns from firstCol are reduced
+ */
+void reduceBlockRow(int* const* rows, unsigned int numBlockRows, unsigned int firstCol,
+					unsigned int numCols, uint8_t* pixels, unsigned int imageCols, ReductionMode mode)
+{
+	for (unsigned int c=0; c<imageCols; c++)
+	{
+		unsigned int startCol = firstCol + blockStart(c, numCols, imageCols),
+					 endCol = firstCol + blockStart(c+1, numCols, imageCols);
+		int value = 0;
+
+		for (unsigned int k=0; k<numBlockRows; k++)
+		{
+			const int* row = rows[k];
+			if (mode == REDUCE_MAX_AGE)
+			{
+				for (unsigned int j=startCol; j<endCol; j++)
+					if (row[j] > value)
+						value = row[j];
+			}
+			else
+			{
+				for (unsigned int j=startCol; j<endCol; j++)
+					value += (row[j] != 0);
+			}
+		}
+
+		if (mode == REDUCE_DENSITY)
+			value = (255*value) / (numBlockRows*(endCol - startCol));
+		pixels[c] = (uint8_t) value;
+	}
+}
@@ -0,0 +1,92 @@
+//
+//  gridSnapshot.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+#include <string.h>
+//
+#include "gridSnapshot.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+RowVersion* rowVersions;
+
+static unsigned int numVersionedRows;
+
+
+void initializeSnapshots(unsigned int numRows)
+{
+	numVersionedRows = numRows;
+	rowVersions = (RowVersion*) aligned_alloc(CACHE_LINE_SIZE, numRows*sizeof(RowVersion));
+	for (unsigned int i=0; i<numRows; i++)
+	{
+		atomic_init(&rowVersions[i].begun, 0);
+		atomic_init(&rowVersions[i].ended, 0);
+	}
+}
+
+void freeSnapshots(void)
+{
+	free(rowVersions);
+}
+
+/*
+ * Copies grid into snapshot, one consistent row at a time.  Returns the
+ * number of rows that were still being written after MAX_SNAPSHOT_TRIES
+ * copies (their last copy is kept:  each cell is valid, but they were not
+ * all read at the same time).
+ */
+unsigned int takeSnapshot(int* const* grid, int** snapshot, unsigned int numRows, unsigned int numCols)
+{
+	return takeRowsSnapshot(grid, snapshot, 0, numRows, 0, numCols, NULL);
+}
+
+/*
+ * Same, for the numCols cells from firstCol of the rows [firstRow, endRow)
+ * of the grid only, copied into snapshot[0 .. endRow-firstRow-1].  If
+ * versions isn't NULL, versions[i] gets the version row i was copied at.
+ */
+unsigned int takeRowsSnapshot(int* const* grid, int** snapshot, unsigned int firstRow, unsigned int endRow,
+							  unsigned int firstCol, unsigned int numCols, unsigned int* versions)
+{
+	unsigned int numUnstableRows = 0;
+
+	for (unsigned int i=firstRow; i<endRow && i<numVersionedRows; i++)
+	{
+		bool stable = false;
+		for (int tries=0; tries<MAX_SNAPSHOT_TRIES && !stable; tries++)
+		{
+			unsigned int ended = atomic_load_explicit(&rowVersions[i].ended, memory_order_acquire);
+			memcpy(snapshot[i - firstRow], grid[i] + firstCol, numCols*sizeof(int));
+			atomic_thread_fence(memory_order_acquire);
+			stable = (atomic_load_explicit(&rowVersions[i].begun, memory_order_relaxed) == ended);
+			//	an unstable copy gets a version older than the row's next
+			//	one, so it is taken again
+			if (versions != NULL)
+				versions[i] = ended;
+		}
+		if (!stable)
+			numUnstableRows++;
+	}
+
+	return numUnstableRows;
+}
+
+/*
+ * True if any of the rows [firstRow, endRow) was written since it was
+ * copied at versions[i] (see takeRowsSnapshot)
+ */
+bool rowsChangedSince(unsigned int firstRow, unsigned int endRow, const unsigned int* versions)
+{
+	for (unsigned int i=firstRow; i<endRow && i<numVersionedRows; i++)
+	{
+		if (atomic_load_explicit(&rowVersions[i].ended, memory_order_relaxed) != versions[i])
+			return true;
+	}
+	return false;
+}
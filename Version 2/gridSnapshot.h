@@ -0,0 +1,61 @@
+//
+//  gridSnapshot.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef GRID_SNAPSHOT_H
+#define GRID_SNAPSHOT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+//
+#include "tileLocks.h"
+
+//-----------------------------------------------------------------------------
+//	Copies of the grid for the renderer (or anybody else who wants to look
+//	at it) taken while the threads keep updating it in place, without any
+//	lock.  Every row has a pair of counters, like a seqlock that several
+//	writers can share:  a thread bumps "begun" before writing a cell of the
+//	row and "ended" once it's done.  A reader copies the row between reading
+//	"ended" and "begun":  if both are equal, no write overlapped the copy
+//	and it is a consistent image of the row.  Otherwise the row is copied
+//	again, up to MAX_SNAPSHOT_TRIES times, so a snapshot never waits long.
+//	The "ended" counter a row was copied at also tells whether the row was
+//	written since (see rowsChangedSince):  a renderer that keeps its copy
+//	only has to take the rows that changed again.
+//-----------------------------------------------------------------------------
+
+#define MAX_SNAPSHOT_TRIES	8
+
+typedef struct RowVersion
+{
+	atomic_uint		begun;
+	atomic_uint		ended;
+} __attribute__((aligned(CACHE_LINE_SIZE))) RowVersion;
+
+extern RowVersion* rowVersions;
+
+void initializeSnapshots(unsigned int numRows);
+void freeSnapshots(void);
+
+unsigned int takeSnapshot(int* const* grid, int** snapshot, unsigned int numRows, unsigned int numCols);
+unsigned int takeRowsSnapshot(int* const* grid, int** snapshot, unsigned int firstRow, unsigned int endRow,
+							  unsigned int firstCol, unsigned int numCols, unsigned int* versions);
+bool rowsChangedSince(unsigned int firstRow, unsigned int endRow, const unsigned int* versions);
+
+
+static inline void beginRowWrite(unsigned int i)
+{
+	atomic_fetch_add_explicit(&rowVersions[i].begun, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+static inline void endRowWrite(unsigned int i)
+{
+	atomic_fetch_add_explicit(&rowVersions[i].ended, 1, memory_order_release);
+}
+
+
+#endif // GRID_SNAPSHOT_H
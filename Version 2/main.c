@@ -20,15 +20,57 @@
 |		- 'c' --> toggle color mode on/off									|
 |		- 'b' --> toggles color mode off/on									|
 |		- 'l' --> toggles on/off grid line rendering						|
+|		- 'd' --> switches between oldest state and density of live			|
+|				  cells, for a grid larger than the pane					|
+|		- 'v' --> shows the whole grid again								|
 |																			|
-|		- '+' --> increase simulation speed									|
-|		- '-' --> reduce simulation speed									|
+|		- mouse wheel --> zoom in/out around the cell under the mouse		|
+|		- left button drag --> move the part of the grid shown				|
+|																			|
+|		- '+' --> double the update rate									|
+|		- '-' --> halve the update rate										|
 |																			|
 |		- '1' --> apply Rule 1 (Conway's classical Game of Life: B3/S23)	|
 |		- '2' --> apply Rule 2 (Coral: B3/S45678)							|
 |		- '3' --> apply Rule 3 (Amoeba: B357/S1358)							|
 |		- '4' --> apply Rule 4 (Maze: B3/S12345)							|
 |																			|
+|	Build (all .c files of this directory):									|
+|																			|
+|		gcc -O2 *.c -lglut -lGL -lpthread -o cell							|
+|																			|
+|	Command line:															|
+|																			|
+|		./cell rows columns [max thread count] [options]					|
+|																			|
+|		--rule B3/S23			any B/S rule, or a rule number 1-4			|
+|		--engine locks|sweep|tiles|domains|replay							|
+|								how concurrent cell updates are kept apart:	|
+|								9 mutexes per update, lock-free sweeps over	|
+|								9 color classes, one mutex per tile, or a	|
+|								band of rows per thread, with a lock only	|
+|								on the edges of the bands, or replay:  like	|
+|								sweep, but a run only depends on the seed,	|
+|								not on the thread count (default: locks)	|
+|		--lock-tile k			size of the tiles of the tiles engine		|
+|								(default: 32)								|
+|		--seed n				seed of the random generators (default:		|
+|								current time), to reproduce a run			|
+|		--rate n|max			cell updates per second, all threads		|
+|								together, or max for no limit (default:		|
+|								10 per thread, 10 sweeps/s for sweep)		|
+|		--sweep-rate n			sweeps of the whole grid per second			|
+|		--count-updates			count the updates of every cell, for the	|
+|								stats of the state pane and "stats"			|
+|		--generations n			run n generations (grids' worth of cell		|
+|								updates) without a window, as fast as		|
+|								possible, print timings and stats, then		|
+|								exit (headless)								|
+|		--seconds t				same, for t seconds (the first limit		|
+|								reached ends the run)						|
+|		--fps n					frames per second the display aims at		|
+|								(default: 60)								|
+|																			|
 +--------------------------------------------------------------------------*/
 
 #include <stdio.h>
@@ -40,8 +82,20 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <semaphore.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdatomic.h>
 //
 #include "gl_frontEnd.h"
+#include "rules.h"
+#include "generationBarrier.h"
+#include "randomGenerator.h"
+#include "tileLocks.h"
+#include "rateControl.h"
+#include "gridSnapshot.h"
+#include "updateStats.h"
+#include "gridReduction.h"
+#include "viewport.h"
 
 //==================================================================================
 //	Custom data types
@@ -55,6 +109,18 @@ typedef struct ThreadInfo
 	//
 } ThreadInfo;
 
+//	How the threads avoid updating a cell while another thread is using it
+typedef enum AsyncEngine
+{
+	ENGINE_LOCKS = 0,	//	lock the 3x3 neighborhood of the cell before updating it
+	ENGINE_SWEEP,		//	lock-free sweeps over the 9 color classes of the grid
+	ENGINE_TILES,		//	lock the tiles overlapped by the 3x3 neighborhood of the cell
+	ENGINE_DOMAINS,		//	each thread updates its own band of rows, locks only on its edges
+	ENGINE_REPLAY,		//	color sweeps that update a subset of the cells picked from the seed
+	//
+	NB_ENGINES
+} AsyncEngine;
+
 
 //==================================================================================
 //	Function prototypes
@@ -63,9 +129,28 @@ void displayGridPane(void);
 void displayStatePane(void);
 void initializeApplication(void);
 void* threadFunc(void*);
-unsigned int cellNewState(unsigned int i, unsigned int j);
-void oneCellGeneration(int i, int j);
+void* sweepThreadFunc(void*);
+void oneRandomCellUpdate(const RuleTable* batchRule);
+void* domainThreadFunc(void*);
+void oneDomainCellUpdate(int threadIndex, int firstRow, int endRow, const RuleTable* batchRule);
+unsigned int lockBandEdges(int threadIndex, bool top, bool bottom, unsigned int heldEdges[2]);
+void resetBand(int threadIndex, int firstRow, int endRow);
+void oneColorSweep(int threadIndex, int color);
+bool replayPicksCell(int i, int j);
+void endOfSweep(void);
+void fillRandomGrid(void);
+void clearUpdateCounts(int i, int firstCol, int endCol);
+void refreshRandom(RandomState* random, unsigned int* version, uint64_t stream);
+const RuleTable* holdRule(int holder);
+void releaseRule(int holder);
+RuleTable* freeRuleSlot(void);
+unsigned int cellNewState(unsigned int i, unsigned int j, const RuleTable* cellRule);
+void oneCellGeneration(int i, int j, const RuleTable* cellRule);
 void* pipeServerThread(void*);
+void checkEndOfRun(double numGenerations);
+unsigned long countLiveCells(void);
+void printHeadlessReport(void);
+double wallClockTime(void);
 
 //==================================================================================
 //	Precompiler #define to let us specify how things should be handled at the
@@ -78,7 +163,10 @@ void* pipeServerThread(void*);
 #define FRAME_CLIPPED		2	//	same rule as elsewhere, with clipping to stay within bounds
 #define FRAME_WRAP			3	//	same rule as elsewhere, with wrapping around at edges
 
-//	Pick one value for FRAME_BEHAVIOR
+//	Pick one value for FRAME_BEHAVIOR.  Unlike Version 1, it can't change at
+//	run time:  the tile locks and the colorings of the grid are laid out for
+//	it at startup (see initializeTileLocks), and they would have to be
+//	rebuilt while the threads update cells in place.
 #define FRAME_BEHAVIOR	FRAME_DEAD
 
 //==================================================================================
@@ -86,6 +174,7 @@ void* pipeServerThread(void*);
 //==================================================================================
 
 extern const int GRID_PANE, STATE_PANE;
+extern const int GRID_PANE_WIDTH, GRID_PANE_HEIGHT;
 extern int gMainWindow, gSubwindow[2];
 
 //	The state grid and its dimensions.  We now have two copies of the grid:
@@ -95,6 +184,47 @@ extern int gMainWindow, gSubwindow[2];
 int* currentGrid;
 int** currentGrid2D;
 
+//	Consistent copy of the cells of the viewport (see viewport.h), taken
+//	without stopping the threads (see gridSnapshot.h), that the front end
+//	displays.  It holds snapshotRows rows of the width of the grid.
+int* snapshotGrid;
+int** snapshotGrid2D;
+unsigned int snapshotRows;
+
+//	A viewport with more cells than the grid pane has pixels is drawn as an
+//	image of at most frameRows x frameCols (see gridReduction.h), reduced by
+//	the renderer one block of rows at a time from small snapshots.  Drawing
+//	then costs the same for any grid size.
+unsigned int frameRows, frameCols;
+ReductionMode reductionMode = REDUCE_MAX_AGE;
+uint8_t* reducedImage;
+uint8_t** reducedImage2D;
+
+//	What the grid pane shows:  the viewport and reduction mode of the last
+//	drawing, and the version each row of the grid was copied at (see
+//	gridSnapshot.h).  As long as the viewport and mode stay the same, only
+//	the rows written since are copied again, and only the rows of the image
+//	they are in (changedImageRows) are uploaded.
+Viewport drawnView;
+ReductionMode drawnMode;
+unsigned int* drawnRowVersions;
+uint8_t* changedImageRows;
+
+//	Number of updates of each cell since the last reset (--count-updates,
+//	NULL otherwise).  A counter is only incremented by the thread that
+//	updates the cell, while it has the cell to itself, so it needs no lock.
+unsigned int* updateCount = NULL;
+unsigned int** updateCount2D;
+bool countUpdates = false;
+
+//	The stats of the counters drawn in the state pane, and when they were
+//	computed (see wallClockTime).  Computing them reads the whole grid of
+//	counters, so it is done at most once per UPDATE_STATS_PERIOD seconds.
+#define UPDATE_STATS_PERIOD		1.0
+
+UpdateStats drawnUpdateStats;
+double updateStatsTime = 0.0;
+
 pthread_mutex_t* gridMutex;
 pthread_mutex_t** gridMutex2D;
 
@@ -105,11 +235,135 @@ int maxThreadCount;
 
 unsigned int numLiveThreads = 0;
 
-unsigned int rule = GAME_OF_LIFE_RULE;
+//	The rule currently applied, compiled into a lookup table (see rules.h).
+//	A compute thread loads it at the start of a batch of updates, hands it
+//	down to the cells, and holds it in heldRules[thread] until the batch is
+//	done (see holdRule).  The sweep engines hold the rule of a whole sweep,
+//	sweepRule, in the last entry of heldRules.  A new rule is compiled into
+//	a slot that is neither current nor held (under ruleLock, as the keyboard
+//	and the pipe may both set one), then swapped in:  a table is never
+//	rewritten while a thread may still read it.
+#define NB_RULE_SLOTS		3
+
+RuleTable ruleSlots[NB_RULE_SLOTS];
+_Atomic(RuleTable*) rule = &ruleSlots[0];
+_Atomic(RuleTable*)* heldRules = NULL;
+int numRuleHolders = 0;
+pthread_mutex_t ruleLock = PTHREAD_MUTEX_INITIALIZER;
+const RuleTable* sweepRule;
 
 unsigned int colorMode = 0;
 
-int sleepTimer = 100000;
+//	Target rate of cell updates, as given on the command line (negative if
+//	not given).  A sweep rate is turned into a rate of cell updates.
+double requestedUpdateRate = -1.0;
+double requestedSweepRate = -1.0;
+
+AsyncEngine engine = ENGINE_LOCKS;
+const char* ENGINE_STR[NB_ENGINES] = {"locks", "sweep", "tiles", "domains", "replay"};
+
+//	Size of the tiles that share a mutex (tiles engine).  The 3x3
+//	neighborhood of a cell must not span more than 2 tiles per dimension.
+unsigned int lockTileSize = 32;
+
+//------------------------------
+//	Color sweep
+//------------------------------
+//	Cell (i, j) has color 3*(i%3) + j%3.  Two cells of the same color are at
+//	least 3 rows or 3 columns apart, so their 3x3 neighborhoods don't
+//	overlap:  all the cells of one color can be updated in place, at the same
+//	time, without any lock.  A sweep goes through the 9 colors in a random
+//	order, with all the threads waiting for each other between two colors.
+#define NB_SWEEP_COLORS		9
+
+int sweepColorOrder[NB_SWEEP_COLORS];
+GenerationBarrier colorBarrier;
+
+//	Rows and columns covered by the colors.  When the frame wraps around, the
+//	last row (column) could get the same color as its neighbor, the first one:
+//	the rows and columns left over past a multiple of 3 are then updated by a
+//	single thread at the end of the sweep.
+int sweepRows, sweepCols;
+
+//	A reset asked for by the front end, applied at the end of the current sweep
+atomic_bool resetRequested = false;
+
+//------------------------------
+//	Deterministic replay
+//------------------------------
+//	The replay engine runs the color sweeps, but at each color only updates
+//	the cells that counterRandom picks from (seed, logical step, cell).
+//	Logical step s is color s%10 of sweep s/10 (the 10th "color" being the
+//	leftover cells of a wrapped-around frame).  Which cells are updated, and
+//	in what order, thus only depends on the seed:  the same run comes out,
+//	bit for bit, with any number of threads.  A reset starts it over.
+#define REPLAY_STEPS_PER_SWEEP		(NB_SWEEP_COLORS + 1)
+
+//	a cell is picked when counterRandom is below this (one cell out of 2)
+#define REPLAY_PICK_THRESHOLD		0x80000000U
+
+unsigned long long sweepNumber = 0;
+__thread unsigned long long replayStep;
+
+//------------------------------
+//	Domain decomposition
+//------------------------------
+//	Thread t owns the rows t*numRows/maxThreadCount up to (excluded)
+//	(t+1)*numRows/maxThreadCount, and only updates cells in there.  A cell
+//	away from the first and last rows of the band only reads cells of the
+//	band, which no other thread writes:  no lock is needed.  Edge e is
+//	shared by the last row of band e and the first row of band e+1 (of band
+//	0 for the last edge, when the frame wraps around):  a thread updating
+//	one of these rows holds the mutex of the edge.
+TileLock* edgeLocks;
+
+//	Bumped by each reset:  every thread then refills its own band
+atomic_uint resetCount = 0;
+
+//------------------------------
+//	Headless runs
+//------------------------------
+//	With --generations or --seconds there is no window:  the threads update
+//	the cells until the first limit is reached (0 means no limit), then main
+//	prints the timings and stats of the run and exits.  A generation is a
+//	grid's worth of cell updates (a sweep, for the sweep and replay engines).
+bool headless = false;
+unsigned long maxGenerations = 0;
+double maxSeconds = 0.0;
+
+//	Set by the first thread to see the end of the run (by endOfSweep, while
+//	the others wait at the barrier, for the sweep and replay engines)
+atomic_bool simulationDone = false;
+
+//	wall clock times (see wallClockTime) of the start of the program, and of
+//	the start and end of the updates
+double launchTime, computeStartTime, computeEndTime;
+
+//------------------------------
+//	Random generators
+//------------------------------
+//	Seed of all the generators (--seed, or "seed" from the pipe).  Each
+//	generator is seeded from it with its own stream number:  the index of the
+//	compute thread, or one of the streams below.  seedVersion is bumped when
+//	the seed changes, and every generator reseeds itself the next time it is
+//	used (see refreshRandom).
+uint64_t randomSeed;
+atomic_uint seedVersion = 1;
+
+#define GRID_RANDOM_STREAM		0xFFFFFFFF00000000ULL
+#define SWEEP_RANDOM_STREAM		0xFFFFFFFF00000001ULL
+
+//	Picks the cells to update and the random frame, in each compute thread
+__thread RandomState threadRandom;
+__thread unsigned int threadSeedVersion = 0;
+
+//	Values of a reset grid
+RandomState gridRandom;
+unsigned int gridSeedVersion = 0;
+
+//	Order of the colors of a sweep (only used by one thread at a time)
+RandomState sweepRandom;
+unsigned int sweepSeedVersion = 0;
 
 //------------------------------
 //	Threads and synchronization
@@ -134,7 +388,49 @@ void displayGridPane(void)
 	//	This is the call that makes OpenGL render the grid.
 	//
 	//---------------------------------------------------------
-	drawGrid(currentGrid2D, numRows, numCols);
+	//	only the cells of the viewport are copied and drawn
+	Viewport view;
+	unsigned int imageRows, imageCols;
+	getViewport(&view);
+	reducedSize(view.numRows, view.numCols, GRID_PANE_HEIGHT, GRID_PANE_WIDTH, &imageRows, &imageCols);
+	ReductionMode mode = reductionMode;
+	bool reduced = (imageRows < view.numRows || imageCols < view.numCols);
+
+	//	the copy from the last drawing can be kept if it shows the same cells
+	bool sameImage = (memcmp(&view, &drawnView, sizeof(Viewport)) == 0 && (!reduced || mode == drawnMode));
+	drawnView = view;
+	drawnMode = mode;
+
+	if(reduced)
+	{
+		//	the threads don't stop, so neither can the image be made in
+		//	parallel with them:  each block of rows is copied then reduced
+		for(unsigned int r = 0; r < imageRows; r++)
+		{
+			unsigned int i = view.firstRow + blockStart(r, view.numRows, imageRows),
+						 endRow = view.firstRow + blockStart(r+1, view.numRows, imageRows);
+			changedImageRows[r] = !sameImage || rowsChangedSince(i, endRow, drawnRowVersions);
+			if(changedImageRows[r])
+			{
+				takeRowsSnapshot(currentGrid2D, snapshotGrid2D, i, endRow, view.firstCol, view.numCols,
+								 drawnRowVersions);
+				reduceBlockRow(snapshotGrid2D, endRow - i, 0, view.numCols, reducedImage2D[r], imageCols, mode);
+			}
+		}
+		drawReducedGrid(reducedImage2D, imageRows, imageCols, mode == REDUCE_DENSITY, changedImageRows);
+	}
+	else
+	{
+		for(unsigned int r = 0; r < view.numRows; r++)
+		{
+			unsigned int i = view.firstRow + r;
+			changedImageRows[r] = !sameImage || rowsChangedSince(i, i+1, drawnRowVersions);
+			if(changedImageRows[r])
+				takeRowsSnapshot(currentGrid2D, snapshotGrid2D + r, i, i+1, view.firstCol, view.numCols,
+								 drawnRowVersions);
+		}
+		drawGrid(snapshotGrid2D, view.numRows, view.numCols, changedImageRows);
+	}
 	
 	//	This is OpenGL/glut magic.
 	glutSwapBuffers();
@@ -156,8 +452,27 @@ void displayStatePane(void)
 	//
 	//---------------------------------------------------------
 	drawState(numLiveThreads, maxThreadCount);
-	drawRule(rule);
-	drawSleepTimer();
+	RuleTable shownRule;
+	pthread_mutex_lock(&ruleLock);
+	shownRule = *atomic_load(&rule);
+	pthread_mutex_unlock(&ruleLock);
+	drawRule(&shownRule);
+	drawUpdateRate(numRows*numCols);
+	if(updateCount != NULL)
+	{
+		double now = wallClockTime();
+		if(updateStatsTime == 0.0 || now - updateStatsTime >= UPDATE_STATS_PERIOD)
+		{
+			computeUpdateStats(updateCount, (size_t) numRows*numCols, &drawnUpdateStats);
+			updateStatsTime = now;
+		}
+		drawUpdateStats(&drawnUpdateStats);
+	}
+	Viewport view;
+	getViewport(&view);
+	bool reduced = (view.numRows > (unsigned int) GRID_PANE_HEIGHT || view.numCols > (unsigned int) GRID_PANE_WIDTH);
+	drawRenderMode(reduced ? REDUCTION_MODE_STR[reductionMode] : "cells", &view, getViewportZoom());
+	drawFrameStats();
 	drawTitle();
 	
 	
@@ -172,23 +487,136 @@ void displayStatePane(void)
  */
 int main(int argc, char** argv)
 {
-	if(argc < 3 || argc > 4)	// if there are too little or too many parameters, print error and exit
+	//	Optional arguments first (getopt moves them out of the way, so they may
+	//	appear anywhere on the command line)
+	static struct option longOptions[] = {
+		{"rule",	required_argument,	NULL,	'r'},
+		{"engine",	required_argument,	NULL,	'e'},
+		{"seed",	required_argument,	NULL,	's'},
+		{"lock-tile",	required_argument,	NULL,	'k'},
+		{"rate",		required_argument,	NULL,	'u'},
+		{"sweep-rate",	required_argument,	NULL,	'w'},
+		{"count-updates",	no_argument,	NULL,	'c'},
+		{"generations",	required_argument,	NULL,	'g'},
+		{"seconds",	required_argument,	NULL,	'd'},
+		{"fps",		required_argument,	NULL,	'F'},
+		{NULL,		0,					NULL,	0}
+	};
+	int opt;
+	launchTime = wallClockTime();
+	setRule("1");
+	randomSeed = (uint64_t) time(NULL);
+	while((opt = getopt_long(argc, argv, "r:e:s:k:u:w:cg:d:F:", longOptions, NULL)) != -1)
+	{
+		switch(opt)
+		{
+			case 'r':
+				if(setRule(optarg) != 0)
+				{
+					printf("\n\nInvalid rule '%s' (expected e.g. B3/S23, or a number 1-4).\n\n", optarg);
+					exit(0);
+				}
+				break;
+
+			case 'e':
+				for(engine = 0; engine < NB_ENGINES; engine++)
+					if(strcmp(optarg, ENGINE_STR[engine]) == 0)
+						break;
+				if(engine == NB_ENGINES)
+				{
+					printf("\n\nInvalid engine '%s' (expected locks, sweep, tiles, domains or replay).\n\n", optarg);
+					exit(0);
+				}
+				break;
+
+			case 's':
+				if(sscanf(optarg, "%" SCNu64, &randomSeed) != 1)
+				{
+					printf("\n\nInvalid seed '%s' (expected a non-negative integer).\n\n", optarg);
+					exit(0);
+				}
+				break;
+
+			case 'k':
+				if(sscanf(optarg, "%u", &lockTileSize) != 1 || lockTileSize < 2)
+				{
+					printf("\n\nInvalid lock tile size '%s' (must be at least 2).\n\n", optarg);
+					exit(0);
+				}
+				break;
+
+			case 'u':
+				if(strcmp(optarg, "max") == 0)
+					requestedUpdateRate = UNTHROTTLED;
+				else if(sscanf(optarg, "%lf", &requestedUpdateRate) != 1 || requestedUpdateRate <= 0.0)
+				{
+					printf("\n\nInvalid rate '%s' (expected updates per second, or max).\n\n", optarg);
+					exit(0);
+				}
+				break;
+
+			case 'w':
+				if(sscanf(optarg, "%lf", &requestedSweepRate) != 1 || requestedSweepRate <= 0.0)
+				{
+					printf("\n\nInvalid sweep rate '%s' (expected sweeps per second).\n\n", optarg);
+					exit(0);
+				}
+				break;
+
+			case 'c':
+				countUpdates = true;
+				break;
+
+			case 'g':
+				if(sscanf(optarg, "%lu", &maxGenerations) != 1 || maxGenerations == 0)
+				{
+					printf("\n\nThe number of generations must be a positive integer.\n\n");
+					exit(0);
+				}
+				headless = true;
+				break;
+
+			case 'd':
+				if(sscanf(optarg, "%lf", &maxSeconds) != 1 || maxSeconds <= 0.0)
+				{
+					printf("\n\nThe number of seconds must be positive.\n\n");
+					exit(0);
+				}
+				headless = true;
+				break;
+
+			case 'F':
+				if(setTargetFps(atof(optarg)) != 0)
+				{
+					printf("\n\nThe frame rate must be between 1 and %d.\n\n", MAX_TARGET_FPS);
+					exit(0);
+				}
+				break;
+
+			default:
+				exit(0);
+		}
+	}
+	int numArgs = argc - optind + 1;		// positional parameters, counting the program name like argc does
+	char** args = argv + optind - 1;
+
+	if(numArgs < 3 || numArgs > 4)	// if there are too little or too many parameters, print error and exit
 	{
-		printf("\n\nMust enter correct format(s): \t./cell 'rows' 'columns' 'max thread count'\n\t\t\t./cell 'rows' 'columns'\n");
+		printf("\n\nMust enter correct format(s): \t./cell 'rows' 'columns' 'max thread count' [--rule B3/S23]\n\t\t\t./cell 'rows' 'columns' [--rule B3/S23]\n");
 		exit(0);
 	}
 	else
 	{
-		if(argc == 4)			// if there are 4 parameters, set the corresponding values for rows, columns, and max thread count
+		if(numArgs == 4)			// if there are 4 parameters, set the corresponding values for rows, columns, and max thread count
 		{
-			sscanf(argv[1], "%d", &numRows);
-			sscanf(argv[2], "%d", &numCols);
-			sscanf(argv[3], "%d", &maxThreadCount);
+			sscanf(args[1], "%d", &numRows);
+			sscanf(args[2], "%d", &numCols);
+			sscanf(args[3], "%d", &maxThreadCount);
 		}
-		else if(argc == 3)		// else if there are 3 parameters, set the corresponding values for rows and columns, then set max thread count to row count
+		else if(numArgs == 3)		// else if there are 3 parameters, set the corresponding values for rows and columns, then set max thread count to row count
 		{
-			sscanf(argv[1], "%d", &numRows);
-			sscanf(argv[2], "%d", &numCols);
+			sscanf(args[1], "%d", &numRows);
+			sscanf(args[2], "%d", &numCols);
 			maxThreadCount = numRows;
 		}
 
@@ -214,8 +642,10 @@ int main(int argc, char** argv)
 	}
 
 
-	//	This takes care of initializing glut and the GUI.
-	initializeFrontEnd(argc, argv, displayGridPane, displayStatePane);
+	//	This takes care of initializing glut and the GUI (a headless run has
+	//	no window, and needs no display)
+	if(!headless)
+		initializeFrontEnd(argc, argv, displayGridPane, displayStatePane);
 	
 	//	Now we can do application-level initialization
 	initializeApplication();
@@ -225,6 +655,8 @@ int main(int argc, char** argv)
 	// declare the array of ThreadInfo structs
 	ThreadInfo threads[maxThreadCount];
 
+	computeStartTime = wallClockTime();
+
 	int errCode;		
 	for(int i = 0; i < maxThreadCount; i++)		// for loop to loop through and create determined number of threads
 	{
@@ -233,7 +665,9 @@ int main(int argc, char** argv)
 		threads[i].index = i;					// index of given thread in ThreadInfo array
 
 		// create the pthread
-		errCode = pthread_create(&threads[i].threadID, NULL, threadFunc, &threads[i]);
+		errCode = pthread_create(&threads[i].threadID, NULL,
+								 (engine == ENGINE_SWEEP || engine == ENGINE_REPLAY) ? sweepThreadFunc :
+								 (engine == ENGINE_DOMAINS ? domainThreadFunc : threadFunc), &threads[i]);
 
 		// increment the number of live threads
 		numLiveThreads++;
@@ -247,23 +681,47 @@ int main(int argc, char** argv)
 		}
 	}
 
+	//	A headless run ends by itself:  wait for the threads, then report
+	if(headless)
+	{
+		for(int i = 0; i < maxThreadCount; i++)
+			pthread_join(threads[i].threadID, NULL);
+		numLiveThreads = 0;
+
+		printHeadlessReport();
+	}
 	//	Now we enter the main loop of the program and to a large extend
 	//	"lose control" over its execution.  The callback functions that 
 	//	we set up earlier will be called when the corresponding event
 	//	occurs
-	glutMainLoop();
+	else
+		glutMainLoop();
 	
-	//	this code is never reached because we only leave the glut main
-	//	loop through an exit call.
+	//	this code is only reached by headless runs, because we only leave
+	//	the glut main loop through an exit call.
 	free(currentGrid2D);
 	free(currentGrid);
+	free(snapshotGrid2D);
+	free(snapshotGrid);
+	free(reducedImage2D);
+	free(reducedImage);
+	free(updateCount2D);
+	free(updateCount);
+	freeSnapshots();
 
 	free(gridMutex2D);
 	free(gridMutex);
+
+	if(engine == ENGINE_SWEEP || engine == ENGINE_REPLAY)
+		destroyBarrier(&colorBarrier);
+	else if(engine == ENGINE_TILES)
+		freeTileLocks();
+	else if(engine == ENGINE_DOMAINS)
+		free(edgeLocks);
 	
 	
-	//	This will never be executed (the exit point will be in one of the
-	//	call back functions).
+	//	Only executed by headless runs (otherwise the exit point will be in
+	//	one of the call back functions).
 	return 0;
 }
 
@@ -300,35 +758,121 @@ void* pipeServerThread(void *unused)
  */
 void initializeApplication(void)
 {
+    //  The snapshot holds the rows of a viewport that fits in the pane, or
+    //  one block of rows (the cells of one row of its image) of a larger one
+    //-----------------------------------------------------------------------
+    initializeViewport(numRows, numCols);
+    reducedSize(numRows, numCols, GRID_PANE_HEIGHT, GRID_PANE_WIDTH, &frameRows, &frameCols);
+    snapshotRows = (numRows + frameRows - 1) / frameRows;
+    if (snapshotRows < frameRows)
+    {
+        snapshotRows = frameRows;
+    }
+
     //  Allocate 1D grids
     //--------------------
     currentGrid = (int*) malloc(numRows*numCols*sizeof(int));
-    gridMutex = (pthread_mutex_t*) malloc(numRows*numCols*sizeof(pthread_mutex_t));
+    snapshotGrid = (int*) calloc(snapshotRows*numCols, sizeof(int));
+    reducedImage = (uint8_t*) calloc(frameRows*frameCols, sizeof(uint8_t));
 
     //  Scaffold 2D arrays on top of the 1D arrays
     //---------------------------------------------
     currentGrid2D = (int**) malloc(numRows*sizeof(int*));
-    gridMutex2D = (pthread_mutex_t**) malloc(numRows*sizeof(pthread_mutex_t*));
+    snapshotGrid2D = (int**) malloc(snapshotRows*sizeof(int*));
+    reducedImage2D = (uint8_t**) malloc(frameRows*sizeof(uint8_t*));
     
     currentGrid2D[0] = currentGrid;
-    gridMutex2D[0] = gridMutex;
     for (int i=1; i<numRows; i++)
     {
         currentGrid2D[i] = currentGrid2D[i-1] + numCols;
-        gridMutex2D[i] = gridMutex2D[i-1] + numCols;
     }
-
-    // initialize all of the locks in the 2D array of mutex locks
-    for(int i = 0; i < numRows; i++)
+    for (unsigned int i=0; i<snapshotRows; i++)
     {
-    	for(int j = 0; j < numCols; j++)
-    	{
-    		pthread_mutex_init(&gridMutex2D[i][j], NULL);
-    	}
+        snapshotGrid2D[i] = snapshotGrid + (size_t) i*numCols;
     }
+    for (unsigned int i=0; i<frameRows; i++)
+    {
+        reducedImage2D[i] = reducedImage + (size_t) i*frameCols;
+    }
+
+	//	one holder of the rule per compute thread, plus the sweeps
+	pthread_mutex_lock(&ruleLock);
+	heldRules = (_Atomic(RuleTable*)*) calloc(maxThreadCount + 1, sizeof(_Atomic(RuleTable*)));
+	numRuleHolders = maxThreadCount + 1;
+	pthread_mutex_unlock(&ruleLock);
+
+	initializeSnapshots(numRows);
+	drawnRowVersions = (unsigned int*) calloc(numRows, sizeof(unsigned int));
+	changedImageRows = (uint8_t*) malloc(frameRows*sizeof(uint8_t));
+
+	if(countUpdates)
+	{
+		updateCount = (unsigned int*) calloc((size_t) numRows*numCols, sizeof(unsigned int));
+		updateCount2D = (unsigned int**) malloc(numRows*sizeof(unsigned int*));
+		for (int i=0; i<numRows; i++)
+			updateCount2D[i] = updateCount + (size_t) i*numCols;
+	}
+
+	//	Only the locks engine needs a mutex per cell
+	if(engine == ENGINE_LOCKS)
+	{
+		gridMutex = (pthread_mutex_t*) malloc(numRows*numCols*sizeof(pthread_mutex_t));
+		gridMutex2D = (pthread_mutex_t**) malloc(numRows*sizeof(pthread_mutex_t*));
+
+		gridMutex2D[0] = gridMutex;
+		for (int i=1; i<numRows; i++)
+			gridMutex2D[i] = gridMutex2D[i-1] + numCols;
+
+		// initialize all of the locks in the 2D array of mutex locks
+		for(int i = 0; i < numRows; i++)
+		{
+			for(int j = 0; j < numCols; j++)
+			{
+				pthread_mutex_init(&gridMutex2D[i][j], NULL);
+			}
+		}
+	}
+	else if(engine == ENGINE_TILES)
+	{
+		initializeTileLocks(numRows, numCols, lockTileSize, FRAME_BEHAVIOR == FRAME_WRAP);
+	}
+	else if(engine == ENGINE_DOMAINS)
+	{
+		edgeLocks = (TileLock*) aligned_alloc(CACHE_LINE_SIZE, maxThreadCount*sizeof(TileLock));
+		for(int e = 0; e < maxThreadCount; e++)
+			pthread_mutex_init(&edgeLocks[e].mutex, NULL);
+	}
+	else
+	{
+		initializeBarrier(&colorBarrier, maxThreadCount);
+		for(int c = 0; c < NB_SWEEP_COLORS; c++)
+			sweepColorOrder[c] = c;
+		sweepRule = holdRule(maxThreadCount);
+
+		#if FRAME_BEHAVIOR == FRAME_WRAP
+			sweepRows = numRows - numRows%3;
+			sweepCols = numCols - numCols%3;
+		#else
+			sweepRows = numRows;
+			sweepCols = numCols;
+		#endif
+	}
 	
-	//	seed the pseudo-random generator
-	srand((unsigned int) time(NULL));
+	//	by default, the pace of the original 0.1 s sleep after each update
+	//	(after each sweep for the sweep engine), or no limit when headless
+	if(requestedSweepRate > 0.0)
+		initializeRateControl(requestedSweepRate*numRows*numCols);
+	else if(requestedUpdateRate >= 0.0)
+		initializeRateControl(requestedUpdateRate);
+	else if(headless)
+		initializeRateControl(UNTHROTTLED);
+	else if(engine == ENGINE_SWEEP || engine == ENGINE_REPLAY)
+		initializeRateControl(10.0*numRows*numCols);
+	else
+		initializeRateControl(10.0*maxThreadCount);
+
+	//	the random generators are seeded from randomSeed when first used
+	printf("Random seed: %" PRIu64 "\n", randomSeed);
 	
 	resetGrid();
 }
@@ -341,89 +885,634 @@ void* threadFunc(void* arg)
 	ThreadInfo* info = (ThreadInfo *) arg;
 
 	// while loop to continue calculating the next generation of cells 
-	while(1)
+	while(!atomic_load(&simulationDone))
+	{
+		refreshRandom(&threadRandom, &threadSeedVersion, info->index);
+
+		// claim the next batch of updates, and wait until it is due
+		unsigned int batchSize = updateBatchSize();
+		paceUpdates(batchSize);
+
+		const RuleTable* batchRule = holdRule(info->index);
+		for(unsigned int u = 0; u < batchSize; u++)
+			oneRandomCellUpdate(batchRule);
+		releaseRule(info->index);
+
+		if(headless)
+			checkEndOfRun((double) getUpdateCount() / (numRows*numCols));
+	}
+	return NULL;
+}
+
+/*
+ * Updates one cell picked at random, holding the locks of the engine
+ */
+void oneRandomCellUpdate(const RuleTable* batchRule)
+{
+	// generate a random index on the x and y axis (row and column)
+	int randomCol = randomBelow(&threadRandom, numCols);
+	int randomRow = randomBelow(&threadRandom, numRows);
+	// lock the tiles under the 3x3 square around the selected cell
+	if (engine == ENGINE_TILES)
+	{
+		unsigned int heldTiles[MAX_TILE_LOCKS];
+		unsigned int numHeld = lockNeighborhood(randomRow, randomCol, heldTiles);
+		oneCellGeneration(randomRow, randomCol, batchRule);
+		unlockTiles(heldTiles, numHeld);
+	}
+	// get the mutex lock for the 3x3 square around the selected cell
+	else if (randomRow>0 && randomRow<numRows-1 && randomCol>0 && randomCol<numCols-1)
+	{
+		pthread_mutex_lock(&gridMutex2D[randomRow - 1][randomCol - 1]);
+		pthread_mutex_lock(&gridMutex2D[randomRow - 1][randomCol]);
+		pthread_mutex_lock(&gridMutex2D[randomRow - 1][randomCol + 1]);
+		pthread_mutex_lock(&gridMutex2D[randomRow][randomCol - 1]);
+		pthread_mutex_lock(&gridMutex2D[randomRow][randomCol]);
+		pthread_mutex_lock(&gridMutex2D[randomRow][randomCol + 1]);
+		pthread_mutex_lock(&gridMutex2D[randomRow + 1][randomCol - 1]);
+		pthread_mutex_lock(&gridMutex2D[randomRow + 1][randomCol]);
+		pthread_mutex_lock(&gridMutex2D[randomRow + 1][randomCol + 1]);
+		//printf("Thread %d acquired all locks.\n", info->index);
+		oneCellGeneration(randomRow, randomCol, batchRule);
+		pthread_mutex_unlock(&gridMutex2D[randomRow - 1][randomCol - 1]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow - 1][randomCol]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow - 1][randomCol + 1]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol - 1]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol + 1]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow + 1][randomCol - 1]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow + 1][randomCol]);
+		pthread_mutex_unlock(&gridMutex2D[randomRow + 1][randomCol + 1]);
+	}
+	else
 	{
-		// generate a random index on the x and y axis (row and column)
-		int randomCol = rand() % (numCols);
-		int randomRow = rand() % (numRows);
-		// get the mutex lock for the 3x3 square around the selected cell
-		if (randomRow>0 && randomRow<numRows-1 && randomCol>0 && randomCol<numCols-1)
+		pthread_mutex_lock(&gridMutex2D[randomRow][randomCol]);
+		//printf("Thread %d acquired single lock.\n", info->index);
+		oneCellGeneration(randomRow, randomCol, batchRule);
+		pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol]);
+	}
+}
+
+/*
+ * Acts as the main function for the thread(s) of the domains engine.
+ * The thread picks its cells at random, but only within its own band.
+ */
+void* domainThreadFunc(void* arg)
+{
+	ThreadInfo* info = (ThreadInfo *) arg;
+	int firstRow = (info->index * numRows) / maxThreadCount;
+	int endRow = ((info->index + 1) * numRows) / maxThreadCount;
+	unsigned int myResetCount = atomic_load(&resetCount);
+
+	while(!atomic_load(&simulationDone))
+	{
+		refreshRandom(&threadRandom, &threadSeedVersion, info->index);
+
+		if(atomic_load(&resetCount) != myResetCount)
 		{
-			pthread_mutex_lock(&gridMutex2D[randomRow - 1][randomCol - 1]);
-			pthread_mutex_lock(&gridMutex2D[randomRow - 1][randomCol]);
-			pthread_mutex_lock(&gridMutex2D[randomRow - 1][randomCol + 1]);
-			pthread_mutex_lock(&gridMutex2D[randomRow][randomCol - 1]);
-			pthread_mutex_lock(&gridMutex2D[randomRow][randomCol]);
-			pthread_mutex_lock(&gridMutex2D[randomRow][randomCol + 1]);
-			pthread_mutex_lock(&gridMutex2D[randomRow + 1][randomCol - 1]);
-			pthread_mutex_lock(&gridMutex2D[randomRow + 1][randomCol]);
-			pthread_mutex_lock(&gridMutex2D[randomRow + 1][randomCol + 1]);
-			//printf("Thread %d acquired all locks.\n", info->index);
-			oneCellGeneration(randomRow, randomCol);
-			pthread_mutex_unlock(&gridMutex2D[randomRow - 1][randomCol - 1]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow - 1][randomCol]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow - 1][randomCol + 1]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol - 1]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol + 1]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow + 1][randomCol - 1]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow + 1][randomCol]);
-			pthread_mutex_unlock(&gridMutex2D[randomRow + 1][randomCol + 1]);
+			myResetCount = atomic_load(&resetCount);
+			resetBand(info->index, firstRow, endRow);
 		}
-		else
+
+		// claim the next batch of updates, and wait until it is due
+		unsigned int batchSize = updateBatchSize();
+		paceUpdates(batchSize);
+
+		const RuleTable* batchRule = holdRule(info->index);
+		for(unsigned int u = 0; u < batchSize; u++)
+			oneDomainCellUpdate(info->index, firstRow, endRow, batchRule);
+		releaseRule(info->index);
+
+		if(headless)
+			checkEndOfRun((double) getUpdateCount() / (numRows*numCols));
+	}
+	return NULL;
+}
+
+/*
+ * Updates one cell picked at random in the band of rows [firstRow, endRow)
+ */
+void oneDomainCellUpdate(int threadIndex, int firstRow, int endRow, const RuleTable* batchRule)
+{
+	int i = firstRow + randomBelow(&threadRandom, endRow - firstRow);
+	int j = randomBelow(&threadRandom, numCols);
+
+	if(i > firstRow && i < endRow-1)
+	{
+		oneCellGeneration(i, j, batchRule);
+	}
+	else
+	{
+		unsigned int heldEdges[2];
+		unsigned int numHeld = lockBandEdges(threadIndex, i == firstRow, i == endRow-1, heldEdges);
+		oneCellGeneration(i, j, batchRule);
+		while(numHeld > 0)
+			pthread_mutex_unlock(&edgeLocks[heldEdges[--numHeld]].mutex);
+	}
+}
+
+/*
+ * Locks the edges above (top) and/or below (bottom) the band of the given
+ * thread, in increasing order, and returns how many were locked.  The edges
+ * of the frame have no lock, unless it wraps around.
+ */
+unsigned int lockBandEdges(int threadIndex, bool top, bool bottom, unsigned int heldEdges[2])
+{
+	unsigned int numHeld = 0;
+	bool wrap = (FRAME_BEHAVIOR == FRAME_WRAP);
+
+	//	a single thread has nobody to share its edges with
+	if(maxThreadCount == 1)
+		return 0;
+
+	if(top && (threadIndex > 0 || wrap))
+		heldEdges[numHeld++] = (threadIndex + maxThreadCount - 1) % maxThreadCount;
+	if(bottom && (threadIndex < maxThreadCount-1 || wrap))
+		heldEdges[numHeld++] = threadIndex;
+
+	if(numHeld == 2 && heldEdges[0] > heldEdges[1])
+	{
+		unsigned int temp = heldEdges[0];
+		heldEdges[0] = heldEdges[1];
+		heldEdges[1] = temp;
+	}
+
+	for(unsigned int e = 0; e < numHeld; e++)
+		pthread_mutex_lock(&edgeLocks[heldEdges[e]].mutex);
+	return numHeld;
+}
+
+/*
+ * Refills the band of the given thread with random values.  Holding the
+ * edges keeps the neighbors from reading the first and last rows meanwhile.
+ */
+void resetBand(int threadIndex, int firstRow, int endRow)
+{
+	unsigned int heldEdges[2];
+	unsigned int numHeld = lockBandEdges(threadIndex, true, true, heldEdges);
+
+	for (int i=firstRow; i<endRow; i++)
+	{
+		beginRowWrite(i);
+		for (int j=0; j<numCols; j++)
+			currentGrid2D[i][j] = randomBelow(&threadRandom, 2);
+		clearUpdateCounts(i, 0, numCols);
+		endRowWrite(i);
+	}
+
+	while(numHeld > 0)
+		pthread_mutex_unlock(&edgeLocks[heldEdges[--numHeld]].mutex);
+}
+
+/*
+ * Acts as the main function for the thread(s) of the sweep engine.
+ * Within a color, the cells don't depend on each other (see NB_SWEEP_COLORS),
+ * so the threads update them in place with no lock.
+ */
+void* sweepThreadFunc(void* arg)
+{
+	ThreadInfo* info = (ThreadInfo *) arg;
+
+	while(!atomic_load(&simulationDone))
+	{
+		refreshRandom(&threadRandom, &threadSeedVersion, info->index);
+
+		bool endedSweep = false;
+		for(int c = 0; c < NB_SWEEP_COLORS; c++)
 		{
-			pthread_mutex_lock(&gridMutex2D[randomRow][randomCol]);
-			//printf("Thread %d acquired single lock.\n", info->index);
-			oneCellGeneration(randomRow, randomCol);
-			pthread_mutex_unlock(&gridMutex2D[randomRow][randomCol]);
+			replayStep = sweepNumber*REPLAY_STEPS_PER_SWEEP + c;
+			oneColorSweep(info->index, sweepColorOrder[c]);
+
+			// nobody starts on the next color before all the cells of this one are done
+			endedSweep = barrierWait(&colorBarrier, (c == NB_SWEEP_COLORS-1) ? endOfSweep : NULL);
 		}
 
-		usleep(sleepTimer);
-		
+		// the threads pick up the next sweep and wait for this one at its first color
+		if(endedSweep)
+			paceUpdates(numRows*numCols);
 	}
 	return NULL;
 }
 
+/*
+ * Updates this thread's share of the cells of the given color:  the rows of
+ * that color are split into one contiguous band per thread.
+ */
+void oneColorSweep(int threadIndex, int color)
+{
+	int firstRow = color / 3, firstCol = color % 3;
+	int numColorRows = (sweepRows - firstRow + 2) / 3;
+	int startK = (threadIndex * numColorRows) / maxThreadCount;
+	int endK = ((threadIndex + 1) * numColorRows) / maxThreadCount;
+
+	for(int k = startK; k < endK; k++)
+	{
+		int i = firstRow + 3*k;
+		for(int j = firstCol; j < sweepCols; j += 3)
+			if(engine != ENGINE_REPLAY || replayPicksCell(i, j))
+				oneCellGeneration(i, j, sweepRule);
+	}
+}
+
+bool replayPicksCell(int i, int j)
+{
+	return counterRandom(randomSeed, replayStep, (uint64_t) i*numCols + j) < REPLAY_PICK_THRESHOLD;
+}
+
+/*
+ * Called by the last thread to finish a sweep, while all the others wait.
+ */
+void endOfSweep(void)
+{
+	//	leftover rows and columns of a wrapped-around frame
+	replayStep = sweepNumber*REPLAY_STEPS_PER_SWEEP + NB_SWEEP_COLORS;
+	for(int i = 0; i < numRows; i++)
+		for(int j = (i < sweepRows) ? sweepCols : 0; j < numCols; j++)
+			if(engine != ENGINE_REPLAY || replayPicksCell(i, j))
+				oneCellGeneration(i, j, sweepRule);
+
+	sweepNumber++;
+
+	//	the next sweep is done with the rule current now
+	sweepRule = holdRule(maxThreadCount);
+
+	//	the updates of this sweep are only claimed once the threads leave the barrier
+	if(headless)
+		checkEndOfRun((double) getUpdateCount() / (numRows*numCols) + 1.0);
+
+	if(atomic_exchange(&resetRequested, false))
+	{
+		//	a replay starts over exactly as on launch:  same grid, same sweeps
+		if(engine == ENGINE_REPLAY)
+		{
+			gridSeedVersion = sweepSeedVersion = 0;
+			sweepNumber = 0;
+			for(int c = 0; c < NB_SWEEP_COLORS; c++)
+				sweepColorOrder[c] = c;
+		}
+
+		fillRandomGrid();
+
+		if(engine == ENGINE_REPLAY)
+			return;
+	}
+
+	//	the colors are visited in a new random order at each sweep
+	refreshRandom(&sweepRandom, &sweepSeedVersion, SWEEP_RANDOM_STREAM);
+	for(int c = NB_SWEEP_COLORS-1; c > 0; c--)
+	{
+		int r = randomBelow(&sweepRandom, c + 1);
+		int temp = sweepColorOrder[c];
+		sweepColorOrder[c] = sweepColorOrder[r];
+		sweepColorOrder[r] = temp;
+	}
+}
+
+void fillRandomGrid(void)
+{
+	refreshRandom(&gridRandom, &gridSeedVersion, GRID_RANDOM_STREAM);
+	for (int i=0; i<numRows; i++)
+	{
+		beginRowWrite(i);
+		for (int j=0; j<numCols; j++)
+			currentGrid2D[i][j] = randomBelow(&gridRandom, 2);
+		clearUpdateCounts(i, 0, numCols);
+		endRowWrite(i);
+	}
+}
 
 void resetGrid(void)
 {
+	//	The sweep, replay and domains threads update the grid without locks,
+	//	so only they can touch it once they are running
+	if(engine == ENGINE_SWEEP || engine == ENGINE_REPLAY || engine == ENGINE_DOMAINS)
+	{
+		if(numLiveThreads == 0)
+			fillRandomGrid();
+		else if(engine != ENGINE_DOMAINS)
+			atomic_store(&resetRequested, true);
+		else
+			atomic_fetch_add(&resetCount, 1);
+		return;
+	}
+
+	refreshRandom(&gridRandom, &gridSeedVersion, GRID_RANDOM_STREAM);
+
+	//	one row of tiles at a time (in increasing tile order, like the threads)
+	if(engine == ENGINE_TILES)
+	{
+		unsigned int numTileCols = (numCols + lockTileSize - 1) / lockTileSize;
+		for (int tileStart=0; tileStart<numRows; tileStart+=lockTileSize)
+		{
+			int tileEnd = (tileStart + (int) lockTileSize < numRows) ? tileStart + (int) lockTileSize : numRows;
+			for (unsigned int tc=0; tc<numTileCols; tc++)
+				lockTile(tileStart / lockTileSize, tc);
+			for (int i=tileStart; i<tileEnd; i++)
+			{
+				beginRowWrite(i);
+				for (int j=0; j<numCols; j++)
+					currentGrid2D[i][j] = randomBelow(&gridRandom, 2);
+				clearUpdateCounts(i, 0, numCols);
+				endRowWrite(i);
+			}
+			for (unsigned int tc=0; tc<numTileCols; tc++)
+				unlockTile(tileStart / lockTileSize, tc);
+		}
+		return;
+	}
+
 	for (int i=0; i<numRows; i++)
 	{
 		for (int j=0; j<numCols; j++)
 		{
 			pthread_mutex_lock(&gridMutex2D[i][j]);
-			currentGrid2D[i][j] = rand() % 2;
+			beginRowWrite(i);
+			currentGrid2D[i][j] = randomBelow(&gridRandom, 2);
+			clearUpdateCounts(i, j, j+1);
+			endRowWrite(i);
 			pthread_mutex_unlock(&gridMutex2D[i][j]);
 		}
 	}
 }
 
+//	A reset starts the count over
+void clearUpdateCounts(int i, int firstCol, int endCol)
+{
+	if(updateCount != NULL)
+		memset(updateCount2D[i] + firstCol, 0, (endCol - firstCol)*sizeof(unsigned int));
+}
+
+/*
+ * Prints the update count stats (on the "stats" command of the pipe)
+ */
+void printUpdateStats(void)
+{
+	if(updateCount == NULL)
+	{
+		printf("Update counts are off (start with --count-updates).\n");
+		return;
+	}
+
+	UpdateStats stats;
+	computeUpdateStats(updateCount, (size_t) numRows*numCols, &stats);
+	printf("Updates: %llu total, per cell: min %u, max %u, mean %.3f, variance %.3f\n",
+		   stats.totalCount, stats.minCount, stats.maxCount, stats.mean, stats.variance);
+	printf("Effective generations: %.3f\n", stats.mean);
+}
+
+/*
+ * Ends a headless run if it did its number of generations, or ran its time.
+ * Called by the compute threads after each batch of updates (each sweep for
+ * the sweep and replay engines).
+ */
+void checkEndOfRun(double numGenerations)
+{
+	double now = wallClockTime();
+
+	if((maxGenerations > 0 && numGenerations >= maxGenerations) ||
+	   (maxSeconds > 0.0 && now - computeStartTime >= maxSeconds))
+	{
+		//	only the first thread to get here gets to set the end time
+		if(!atomic_exchange(&simulationDone, true))
+			computeEndTime = now;
+	}
+}
+
+/*
+ * Prints the timings and final state of a headless run, once all the compute
+ * threads are done
+ */
+void printHeadlessReport(void)
+{
+	double computeTime = computeEndTime - computeStartTime;
+	double numCells = (double) numRows * numCols;
+	unsigned long long numUpdates = getUpdateCount();
+	unsigned long numLive = countLiveCells();
+
+	printf("\nHeadless run:  %d x %d cells, %d threads, engine %s, rule %s, color %s, seed %" PRIu64 "\n",
+		   numRows, numCols, maxThreadCount, ENGINE_STR[engine], atomic_load(&rule)->str, colorMode ? "on" : "off", randomSeed);
+
+	printf("\tsetup:         %.3f s\n", computeStartTime - launchTime);
+	//	a replay sweep only updates some of the cells
+	if(engine == ENGINE_SWEEP || engine == ENGINE_REPLAY)
+		printf("\tsweeps:        %.0f in %.3f s\n", numUpdates / numCells, computeTime);
+	else
+		printf("\tcell updates:  %llu in %.3f s (%.2f generations)\n", numUpdates, computeTime,
+			   numUpdates / numCells);
+	if(computeTime > 0.0)
+		printf("\t               %.1f generations/s, %.4g cells/s\n", numUpdates / numCells / computeTime,
+			   numUpdates / computeTime);
+	printf("\tlive cells:    %lu of %.0f (%.1f%%)\n", numLive, numCells, 100.0 * numLive / numCells);
+	if(updateCount != NULL)
+		printUpdateStats();
+	fflush(stdout);
+}
+
+//	Only called once no thread updates the grid anymore
+unsigned long countLiveCells(void)
+{
+	unsigned long numLive = 0;
+	for(int i = 0; i < numRows; i++)
+		for(int j = 0; j < numCols; j++)
+			numLive += (currentGrid2D[i][j] != 0);
+	return numLive;
+}
+
+//	Seconds on a clock that doesn't jump, for the timings of headless runs
+double wallClockTime(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + 1.e-9*now.tv_nsec;
+}
+
+/*
+ * Restarts every random generator from the given seed, and resets the grid
+ * so that the run can be reproduced from there.
+ */
+void setSeed(uint64_t seed)
+{
+	randomSeed = seed;
+	atomic_fetch_add(&seedVersion, 1);
+
+	resetGrid();
+}
+
+void setSweepRate(double sweepsPerSecond)
+{
+	setUpdateRate(sweepsPerSecond*numRows*numCols);
+}
+
+/*
+ * Reseeds the generator if the seed was changed since it was last seeded.
+ */
+void refreshRandom(RandomState* random, unsigned int* version, uint64_t stream)
+{
+	unsigned int currentVersion = atomic_load(&seedVersion);
+
+	if(*version != currentVersion)
+	{
+		*version = currentVersion;
+		seedRandom(random, randomSeed, stream);
+	}
+}
+
+/*
+ * Selects how a grid larger than the pane is drawn, by name (maxage or
+ * density), from the next frame on.  Returns 0 on success, -1 if the name
+ * is unknown.
+ */
+int setReductionMode(const char* name)
+{
+	for (int m=0; m<NB_REDUCTION_MODES; m++)
+	{
+		size_t len = strlen(REDUCTION_MODE_STR[m]);
+
+		//	the name may be followed by the end of line of a pipe command
+		if (strncmp(name, REDUCTION_MODE_STR[m], len) == 0 &&
+			(name[len] == '\0' || name[len] == '\n' || name[len] == ' '))
+		{
+			reductionMode = (ReductionMode) m;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+//	Switches to the next way of drawing a grid larger than the pane
+void cycleReductionMode(void)
+{
+	reductionMode = (ReductionMode) ((reductionMode + 1) % NB_REDUCTION_MODES);
+}
+
+//	Grids' worth of cell updates since the start, for the rate shown in the state pane
+double generationsComputed(void)
+{
+	return (double) getUpdateCount() / ((double) numRows*numCols);
+}
+
+/*
+ * True if the cells the grid pane shows were written since it was last
+ * drawn, or it should show other cells.  Otherwise the front end doesn't
+ * draw the window again (see myTimer).
+ */
+int gridChanged(void)
+{
+	Viewport view;
+	getViewport(&view);
+
+	return memcmp(&view, &drawnView, sizeof(Viewport)) != 0 || reductionMode != drawnMode ||
+		   rowsChangedSince(view.firstRow, view.firstRow + view.numRows, drawnRowVersions);
+}
+
+/*
+ * Compiles the given rule (B/S string or preset number, see parseRule) and
+ * makes it the current rule:  the threads pick it up with their next batch
+ * of updates.  Returns 0 on success, -1 if the rule is invalid (in which
+ * case the current rule is not changed).
+ */
+int setRule(const char* ruleStr)
+{
+	RuleTable newRule;
+
+	if(parseRule(ruleStr, &newRule) != 0)
+		return -1;
+
+	pthread_mutex_lock(&ruleLock);
+	RuleTable* slot = freeRuleSlot();
+	*slot = newRule;
+	atomic_store(&rule, slot);
+	pthread_mutex_unlock(&ruleLock);
+	return 0;
+}
+
+/*
+ * Returns one of the rule slots that is neither the current rule nor held
+ * by a thread.  Called with ruleLock held.  If the threads still hold all
+ * the others, waits for the end of one of their batches.
+ */
+RuleTable* freeRuleSlot(void)
+{
+	while(true)
+	{
+		for(int s = 0; s < NB_RULE_SLOTS; s++)
+		{
+			RuleTable* slot = &ruleSlots[s];
+			bool inUse = (slot == atomic_load(&rule));
+			for(int h = 0; h < numRuleHolders && !inUse; h++)
+				inUse = (atomic_load(&heldRules[h]) == slot);
+			if(!inUse)
+				return slot;
+		}
+		usleep(1000);
+	}
+}
+
+/*
+ * Loads the current rule and marks it as held by the given holder (see
+ * heldRules) until releaseRule, or until the holder loads it again.  The
+ * rule is checked again once marked:  if setRule swapped in a new one
+ * meanwhile, it may have missed the mark, so the new one is taken instead.
+ */
+const RuleTable* holdRule(int holder)
+{
+	RuleTable* held;
+	do
+	{
+		held = atomic_load(&rule);
+		atomic_store(&heldRules[holder], held);
+	}
+	while(atomic_load(&rule) != held);
+
+	return held;
+}
+
+void releaseRule(int holder)
+{
+	atomic_store(&heldRules[holder], NULL);
+}
+
 /*
  * This function generates one cell indexed by the given parameters.
  */
-void oneCellGeneration(int i, int j)
+void oneCellGeneration(int i, int j, const RuleTable* cellRule)
 {
-	unsigned int newState = cellNewState(i, j);
+	unsigned int newState = cellNewState(i, j, cellRule);
+	int oldState = currentGrid2D[i][j];
+	int state = oldState;
 
 	//	In black and white mode, only alive/dead matters
 	//	Dead is dead in any mode
 	if (colorMode == 0 || newState == 0)
 	{
-		currentGrid2D[i][j] = newState;
+		state = newState;
 	}
 	//	in color mode, color reflext the "age" of a live cell
 	else
 	{
 		//	Any cell that has not yet reached the "very old cell"
 		//	stage simply got one generation older
-		if (currentGrid2D[i][j] < NB_COLORS-1)
-			currentGrid2D[i][j] = currentGrid2D[i][j] + 1;
+		if (oldState < NB_COLORS-1)
+			state = oldState + 1;
 		//	An old cell remains old until it dies
 
 	}
+
+	if (updateCount != NULL)
+		updateCount2D[i][j]++;
+
+	//	A cell that keeps its state isn't written, so that the row keeps its
+	//	version and the renderer doesn't copy it again.  Otherwise tell the
+	//	snapshots that the row is being written (see gridSnapshot.h).
+	if (state != oldState)
+	{
+		beginRowWrite(i);
+		currentGrid2D[i][j] = state;
+		endRowWrite(i);
+	}
 }
 
-unsigned int cellNewState(unsigned int i, unsigned int j)
+unsigned int cellNewState(unsigned int i, unsigned int j, const RuleTable* cellRule)
 {
 	//	First count the number of neighbors that are alive
 	int count = 0;
@@ -447,12 +1536,14 @@ unsigned int cellNewState(unsigned int i, unsigned int j)
 	{
 		#if FRAME_BEHAVIOR == FRAME_DEAD
 		
-			//	Hack to force death of a cell
-			count = -1;
+			//	cells on the border are kept dead
+			return 0;
 		
 		#elif FRAME_BEHAVIOR == FRAME_RANDOM
 		
-			count = rand() % 9;
+			count = (engine == ENGINE_REPLAY) ?
+						counterRandom(randomSeed, replayStep, (uint64_t) (numRows + i)*numCols + j) % 9 :
+						randomBelow(&threadRandom, 9);
 		
 		#elif FRAME_BEHAVIOR == FRAME_CLIPPED
 	
@@ -482,20 +1573,20 @@ unsigned int cellNewState(unsigned int i, unsigned int j)
 			}
 			
 	
-		#elif FRAME_BEHAVIOR == FRAME_WRAPPED
+		#elif FRAME_BEHAVIOR == FRAME_WRAP
 	
 			unsigned int 	iM1 = (i+numRows-1)%numRows,
 							iP1 = (i+1)%numRows,
 							jM1 = (j+numCols-1)%numCols,
 							jP1 = (j+1)%numCols;
-			count = currentGrid2D[iM1][jM1] != 0 +
-					currentGrid2D[iM1][j] != 0 +
-					currentGrid2D[iM1][jP1] != 0  +
-					currentGrid2D[i][jM1] != 0  +
-					currentGrid2D[i][jP1] != 0  +
-					currentGrid2D[iP1][jM1] != 0  +
-					currentGrid2D[iP1][j] != 0  +
-					currentGrid2D[iP1][jP1] != 0 ;
+			count = (currentGrid2D[iM1][jM1] != 0) +
+					(currentGrid2D[iM1][j] != 0) +
+					(currentGrid2D[iM1][jP1] != 0)  +
+					(currentGrid2D[i][jM1] != 0)  +
+					(currentGrid2D[i][jP1] != 0)  +
+					(currentGrid2D[iP1][jM1] != 0)  +
+					(currentGrid2D[iP1][j] != 0)  +
+					(currentGrid2D[iP1][jP1] != 0);
 
 		#else
 			#error undefined frame behavior
@@ -505,87 +1596,7 @@ unsigned int cellNewState(unsigned int i, unsigned int j)
 	
 	//	Next apply the cellular automaton rule
 	//----------------------------------------------------
-	//	by default, the grid square is going to be empty/dead
-	unsigned int newState = 0;
-	
-	//	unless....
-	
-	switch (rule)
-	{
-		//	Rule 1 (Conway's classical Game of Life: B3/S23)
-		case GAME_OF_LIFE_RULE:
-
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count == 3 || count == 2)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 3)
-					newState = 1;
-			}
-			break;
-	
-		//	Rule 2 (Coral Growth: B3/S45678)
-		case CORAL_GROWTH_RULE:
-
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count > 3)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 3)
-					newState = 1;
-			}
-			break;
-			
-		//	Rule 3 (Amoeba: B357/S1358)
-		case AMOEBA_RULE:
-
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count == 1 || count == 3 || count == 5 || count == 8)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 1 || count == 3 || count == 5 || count == 8)
-					newState = 1;
-			}
-			break;
-		
-		//	Rule 4 (Maze: B3/S12345)							|
-		case MAZE_RULE:
-
-			//	if the cell is currently occupied by a live cell, look at "Stay alive rule"
-			if (currentGrid2D[i][j] != 0)
-			{
-				if (count >= 1 && count <= 5)
-					newState = 1;
-			}
-			//	if the grid square is currently empty, look at the "Birth of a new cell" rule
-			else
-			{
-				if (count == 3)
-					newState = 1;
-			}
-			break;
-
-			break;
-		
-		default:
-			printf("Invalid rule number\n");
-			exit(5);
-	}
-
-	return newState;
+	//	The rule was compiled into a table of the next state for every
+	//	(alive, neighbor count) pair, so there is nothing left to test.
+	return cellRule->newState[currentGrid2D[i][j] != 0][count];
 }
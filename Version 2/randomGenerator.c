@@ -0,0 +1,21 @@
+//
+//  randomGenerator.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include "randomGenerator.h"
+
+
+/*
+ * The seed and the stream number are mixed with splitmix64, so that nearby
+ * seeds or streams (0, 1, 2...) still start far apart.  xorshift must never
+ * start from 0.
+ */
+void seedRandom(RandomState* random, uint64_t seed, uint64_t stream)
+{
+	uint64_t z = mixBits(seed + (stream + 1) * 0x9E3779B97F4A7C15ULL);
+
+	random->state = (z != 0) ? z : 0x9E3779B97F4A7C15ULL;
+}
@@ -0,0 +1,60 @@
+//
+//  randomGenerator.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef RANDOM_GENERATOR_H
+#define RANDOM_GENERATOR_H
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+//	Small xorshift64* pseudo-random generator.  Each thread owns one, so the
+//	threads don't all go through the hidden (and locked) state of rand().
+//	A generator is seeded from a seed and a stream number (the thread index,
+//	for instance):  the same seed always gives the same sequence for a
+//	given stream, and different streams give unrelated sequences.
+//	counterRandom is stateless instead:  the same (seed, counter, index)
+//	always gives the same value, whichever thread asks and in any order.
+//-----------------------------------------------------------------------------
+
+typedef struct RandomState
+{
+	uint64_t	state;
+} RandomState;
+
+void seedRandom(RandomState* random, uint64_t seed, uint64_t stream);
+
+//	splitmix64 finalizer:  nearby inputs give unrelated outputs
+static inline uint64_t mixBits(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static inline uint32_t counterRandom(uint64_t seed, uint64_t counter, uint64_t index)
+{
+	return (uint32_t) (mixBits(mixBits(seed + counter * 0x9E3779B97F4A7C15ULL) + index) >> 32);
+}
+
+static inline uint32_t nextRandom(RandomState* random)
+{
+	uint64_t x = random->state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	random->state = x;
+	return (uint32_t) ((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+//	Uniform in [0, bound), with a multiplication instead of a modulo
+static inline unsigned int randomBelow(RandomState* random, unsigned int bound)
+{
+	return (unsigned int) (((uint64_t) nextRandom(random) * bound) >> 32);
+}
+
+
+#endif // RANDOM_GENERATOR_H
@@ -0,0 +1,185 @@
+//
+//  rateControl.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+//
+#include "rateControl.h"
+
+//	A change of rate starts a new schedule:  update number startCount + n
+//	is due n/rate seconds after startTime
+typedef struct RateSchedule
+{
+	double				rate;
+	double				startTime;
+	unsigned long long	startCount;
+} RateSchedule;
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+//	The current schedule, read by the threads with readSchedule.  It is only
+//	written under scheduleLock (the keyboard and the pipe may both set a
+//	rate), and scheduleVersion is odd while it is:  a reader that saw the
+//	version change copies the schedule again, so it never mixes the fields
+//	of two schedules.
+static _Atomic double scheduleRate = UNTHROTTLED;
+static _Atomic double scheduleStartTime = 0.0;
+static atomic_ullong scheduleStartCount = 0;
+static atomic_uint scheduleVersion = 0;
+static pthread_mutex_t scheduleLock = PTHREAD_MUTEX_INITIALIZER;
+
+//	Number of updates handed out since the start
+static atomic_ullong numIssued = 0;
+
+//	Longest sleep before looking at the schedule again, so that a new rate
+//	is picked up quickly by a thread that was waiting on a very slow one
+static const double MAX_SLEEP_TIME = 0.05;
+
+
+static double currentTime(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + 1.e-9*now.tv_nsec;
+}
+
+//	Consistent copy of the current schedule
+static void readSchedule(RateSchedule* copy)
+{
+	unsigned int version;
+
+	do
+	{
+		version = atomic_load_explicit(&scheduleVersion, memory_order_acquire);
+		copy->rate = atomic_load_explicit(&scheduleRate, memory_order_relaxed);
+		copy->startTime = atomic_load_explicit(&scheduleStartTime, memory_order_relaxed);
+		copy->startCount = atomic_load_explicit(&scheduleStartCount, memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+	}
+	while ((version & 1) != 0 || atomic_load_explicit(&scheduleVersion, memory_order_relaxed) != version);
+}
+
+void initializeRateControl(double updatesPerSecond)
+{
+	setUpdateRate(updatesPerSecond);
+}
+
+//	Starts a new schedule at the given rate.  Called with scheduleLock held.
+static void writeSchedule(double updatesPerSecond)
+{
+	unsigned int version = atomic_load_explicit(&scheduleVersion, memory_order_relaxed);
+	atomic_store_explicit(&scheduleVersion, version + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	atomic_store_explicit(&scheduleRate, (updatesPerSecond > 0.0) ? updatesPerSecond : UNTHROTTLED,
+						  memory_order_relaxed);
+	atomic_store_explicit(&scheduleStartTime, currentTime(), memory_order_relaxed);
+	atomic_store_explicit(&scheduleStartCount, atomic_load(&numIssued), memory_order_relaxed);
+
+	atomic_store_explicit(&scheduleVersion, version + 2, memory_order_release);
+}
+
+void setUpdateRate(double updatesPerSecond)
+{
+	pthread_mutex_lock(&scheduleLock);
+	writeSchedule(updatesPerSecond);
+	pthread_mutex_unlock(&scheduleLock);
+}
+
+/*
+ * Multiplies the target rate by the given factor.  When unthrottled, slowing
+ * down starts from the rate actually reached.
+ */
+void scaleUpdateRate(double factor)
+{
+	pthread_mutex_lock(&scheduleLock);
+
+	double rate = getUpdateRate();
+
+	//	there is nothing faster than unthrottled
+	if (rate != UNTHROTTLED || factor < 1.0)
+	{
+		if (rate == UNTHROTTLED)
+			rate = getMeasuredUpdateRate();
+
+		//	never fall down to 0, which would mean unthrottled
+		writeSchedule((rate*factor >= 1.0) ? rate*factor : 1.0);
+	}
+
+	pthread_mutex_unlock(&scheduleLock);
+}
+
+double getUpdateRate(void)
+{
+	RateSchedule current;
+	readSchedule(&current);
+	return current.rate;
+}
+
+/*
+ * Average number of updates per second since the rate was last set
+ */
+double getMeasuredUpdateRate(void)
+{
+	RateSchedule current;
+	readSchedule(&current);
+	double elapsed = currentTime() - current.startTime;
+
+	if (elapsed <= 0.0)
+		return 0.0;
+	return (atomic_load(&numIssued) - current.startCount) / elapsed;
+}
+
+//	Number of updates claimed by the threads since the start
+unsigned long long getUpdateCount(void)
+{
+	return atomic_load(&numIssued);
+}
+
+/*
+ * About one millisecond's worth of updates, so that a thread checks the
+ * clock once per batch rather than once per update
+ */
+unsigned int updateBatchSize(void)
+{
+	double rate = getUpdateRate();
+
+	if (rate == UNTHROTTLED || rate >= 1000.0*MAX_UPDATE_BATCH)
+		return MAX_UPDATE_BATCH;
+	if (rate < 1000.0)
+		return 1;
+	return (unsigned int) (rate / 1000.0);
+}
+
+/*
+ * Claims numUpdates updates, and returns when the last one is due
+ */
+void paceUpdates(unsigned int numUpdates)
+{
+	unsigned long long lastUpdate = atomic_fetch_add(&numIssued, numUpdates) + numUpdates;
+
+	while (1)
+	{
+		RateSchedule current;
+		readSchedule(&current);
+		if (current.rate == UNTHROTTLED || lastUpdate <= current.startCount)
+			return;
+
+		double wait = current.startTime + (lastUpdate - current.startCount) / current.rate
+						- currentTime();
+		if (wait <= 0.0)
+			return;
+		if (wait > MAX_SLEEP_TIME)
+			wait = MAX_SLEEP_TIME;
+
+		struct timespec sleepTime = {(time_t) wait, (long) (1.e9*(wait - (time_t) wait))};
+		nanosleep(&sleepTime, NULL);
+	}
+}
@@ -0,0 +1,38 @@
+//
+//  rateControl.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef RATE_CONTROL_H
+#define RATE_CONTROL_H
+
+//-----------------------------------------------------------------------------
+//	Paces the cell updates of all the threads together to a target rate,
+//	in cell updates per second (0 means unthrottled).  A thread claims a
+//	batch of updates with paceUpdates:  the batch gets the next numbers in a
+//	global count of updates, and the call sleeps until the last of them is
+//	due at the target rate.  The threads never wait for each other, only for
+//	the clock.
+//-----------------------------------------------------------------------------
+
+#define UNTHROTTLED		0.0
+
+//	Largest batch claimed at once:  keeps the shared counter out of the way
+//	without making the pacing too coarse
+#define MAX_UPDATE_BATCH	4096
+
+void initializeRateControl(double updatesPerSecond);
+
+void setUpdateRate(double updatesPerSecond);
+void scaleUpdateRate(double factor);
+double getUpdateRate(void);
+double getMeasuredUpdateRate(void);
+unsigned long long getUpdateCount(void);
+
+unsigned int updateBatchSize(void);
+void paceUpdates(unsigned int numUpdates);
+
+
+#endif // RATE_CONTROL_H
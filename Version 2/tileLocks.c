@@ -0,0 +1,142 @@
+//
+//  tileLocks.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <stdlib.h>
+//
+#include "tileLocks.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+static TileLock* tileLocks;
+
+static unsigned int numGridRows, numGridCols;
+static unsigned int numTileRows, numTileCols;
+static unsigned int lockTileSize;
+static bool wrap;
+
+
+void initializeTileLocks(unsigned int numRows, unsigned int numCols, unsigned int tileSize,
+						 bool wrapAround)
+{
+	numGridRows = numRows;
+	numGridCols = numCols;
+	lockTileSize = tileSize;
+	wrap = wrapAround;
+
+	numTileRows = (numRows + tileSize - 1) / tileSize;
+	numTileCols = (numCols + tileSize - 1) / tileSize;
+
+	tileLocks = (TileLock*) aligned_alloc(CACHE_LINE_SIZE, numTileRows*numTileCols*sizeof(TileLock));
+	for (unsigned int t=0; t<numTileRows*numTileCols; t++)
+		pthread_mutex_init(&tileLocks[t].mutex, NULL);
+}
+
+void freeTileLocks(void)
+{
+	for (unsigned int t=0; t<numTileRows*numTileCols; t++)
+		pthread_mutex_destroy(&tileLocks[t].mutex);
+	free(tileLocks);
+}
+
+/*
+ * Stores in tiles, in increasing order and without duplicates, the tiles
+ * (along one dimension) holding the cells k-1, k and k+1.  Returns how
+ * many there are.
+ */
+static unsigned int neighborTiles(int k, unsigned int numCells, unsigned int tiles[3])
+{
+	int before = k-1, after = k+1;
+	unsigned int numTiles = 0;
+
+	if (wrap)
+	{
+		before = (before + (int) numCells) % (int) numCells;
+		after = after % (int) numCells;
+	}
+	else
+	{
+		if (before < 0)
+			before = 0;
+		if (after >= (int) numCells)
+			after = (int) numCells - 1;
+	}
+
+	//	without wrap-around (or away from the edges) before <= k <= after,
+	//	otherwise one of them jumped to the other side of the grid
+	unsigned int candidates[3] = {before / lockTileSize, k / lockTileSize, after / lockTileSize};
+	for (int c=0; c<3; c++)
+	{
+		unsigned int t = candidates[c], pos = numTiles;
+		bool duplicate = false;
+		for (unsigned int s=0; s<numTiles; s++)
+			duplicate = duplicate || (tiles[s] == t);
+		if (duplicate)
+			continue;
+
+		//	insertion in sorted order
+		while (pos > 0 && tiles[pos-1] > t)
+		{
+			tiles[pos] = tiles[pos-1];
+			pos--;
+		}
+		tiles[pos] = t;
+		numTiles++;
+	}
+	return numTiles;
+}
+
+/*
+ * Locks all the tiles overlapped by the 3x3 neighborhood of cell (i, j) and
+ * stores their indices in heldTiles, for unlockTiles.  Returns how many
+ * tiles were locked.
+ */
+unsigned int lockNeighborhood(int i, int j, unsigned int heldTiles[MAX_TILE_LOCKS])
+{
+	//	most of the time, the whole neighborhood is inside the tile of the cell
+	unsigned int rowInTile = i % lockTileSize, colInTile = j % lockTileSize;
+	if (rowInTile > 0 && rowInTile < lockTileSize-1 && (unsigned int) i+1 < numGridRows &&
+		colInTile > 0 && colInTile < lockTileSize-1 && (unsigned int) j+1 < numGridCols)
+	{
+		heldTiles[0] = (i / lockTileSize)*numTileCols + j / lockTileSize;
+		pthread_mutex_lock(&tileLocks[heldTiles[0]].mutex);
+		return 1;
+	}
+
+	unsigned int rows[3], cols[3];
+	unsigned int numRowTiles = neighborTiles(i, numGridRows, rows);
+	unsigned int numColTiles = neighborTiles(j, numGridCols, cols);
+	unsigned int numHeld = 0;
+
+	//	row-major order is increasing tile index order
+	for (unsigned int r=0; r<numRowTiles; r++)
+		for (unsigned int c=0; c<numColTiles; c++)
+		{
+			heldTiles[numHeld] = rows[r]*numTileCols + cols[c];
+			pthread_mutex_lock(&tileLocks[heldTiles[numHeld]].mutex);
+			numHeld++;
+		}
+
+	return numHeld;
+}
+
+void unlockTiles(const unsigned int* heldTiles, unsigned int numHeld)
+{
+	for (unsigned int t=numHeld; t>0; t--)
+		pthread_mutex_unlock(&tileLocks[heldTiles[t-1]].mutex);
+}
+
+void lockTile(unsigned int tileRow, unsigned int tileCol)
+{
+	pthread_mutex_lock(&tileLocks[tileRow*numTileCols + tileCol].mutex);
+}
+
+void unlockTile(unsigned int tileRow, unsigned int tileCol)
+{
+	pthread_mutex_unlock(&tileLocks[tileRow*numTileCols + tileCol].mutex);
+}
@@ -0,0 +1,46 @@
+//
+//  tileLocks.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef TILE_LOCKS_H
+#define TILE_LOCKS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+//-----------------------------------------------------------------------------
+//	One mutex per tileSize x tileSize tile of the grid, instead of one per
+//	cell.  To update a cell, a thread locks every tile that the 3x3
+//	neighborhood of the cell overlaps:  a single one away from the edges of
+//	the tiles, at most four otherwise (up to nine on a wrapped-around frame
+//	whose last tile row or column is only one cell wide).  The tiles are
+//	always locked in increasing order of their index, so two threads can
+//	never wait for each other in a cycle.
+//-----------------------------------------------------------------------------
+
+//	Each mutex gets a cache line of its own, so that threads working on
+//	neighboring tiles don't keep stealing the line from each other
+#define CACHE_LINE_SIZE		64
+
+#define MAX_TILE_LOCKS		9
+
+typedef struct TileLock
+{
+	pthread_mutex_t		mutex;
+} __attribute__((aligned(CACHE_LINE_SIZE))) TileLock;
+
+void initializeTileLocks(unsigned int numRows, unsigned int numCols, unsigned int tileSize,
+						 bool wrapAround);
+void freeTileLocks(void);
+
+unsigned int lockNeighborhood(int i, int j, unsigned int heldTiles[MAX_TILE_LOCKS]);
+void unlockTiles(const unsigned int* heldTiles, unsigned int numHeld);
+
+void lockTile(unsigned int tileRow, unsigned int tileCol);
+void unlockTile(unsigned int tileRow, unsigned int tileCol);
+
+
+#endif // TILE_LOCKS_H
@@ -0,0 +1,39 @@
+//
+//  updateStats.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include "updateStats.h"
+
+
+/*
+ * The counters keep changing while we read them (they are not locked), so
+ * the result is only approximately that of a single instant.
+ */
+void computeUpdateStats(const unsigned int* counts, size_t numCells, UpdateStats* stats)
+{
+	unsigned long long total = 0;
+	unsigned int minCount = (numCells > 0) ? counts[0] : 0, maxCount = minCount;
+	double sumOfSquares = 0.0;
+
+	for (size_t c=0; c<numCells; c++)
+	{
+		unsigned int count = counts[c];
+		total += count;
+		sumOfSquares += (double) count * count;
+		if (count < minCount)
+			minCount = count;
+		if (count > maxCount)
+			maxCount = count;
+	}
+
+	stats->totalCount = total;
+	stats->minCount = minCount;
+	stats->maxCount = maxCount;
+	stats->mean = (numCells > 0) ? (double) total / numCells : 0.0;
+	stats->variance = (numCells > 0) ? sumOfSquares / numCells - stats->mean*stats->mean : 0.0;
+	if (stats->variance < 0.0)
+		stats->variance = 0.0;
+}
@@ -0,0 +1,31 @@
+//
+//  updateStats.h
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#ifndef UPDATE_STATS_H
+#define UPDATE_STATS_H
+
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+//	Summary of the number of times each cell was updated (--count-updates).
+//	With asynchronous updates, the mean is the number of "generations" the
+//	grid went through, and the spread shows how evenly the cells were picked.
+//-----------------------------------------------------------------------------
+
+typedef struct UpdateStats
+{
+	unsigned long long	totalCount;
+	unsigned int		minCount;
+	unsigned int		maxCount;
+	double				mean;
+	double				variance;
+} UpdateStats;
+
+void computeUpdateStats(const unsigned int* counts, size_t numCells, UpdateStats* stats);
+
+
+#endif // UPDATE_STATS_H
@@ -0,0 +1,146 @@
+//
+//  viewport.c
+//  Cellular Automaton
+//
+//  Nathan Larson 2018-04-22
+//
+
+#include <pthread.h>
+//
+#include "viewport.h"
+
+//---------------------------------------------------------------------------
+//  File-level global variables
+//---------------------------------------------------------------------------
+
+static unsigned int gridNumRows = 1, gridNumCols = 1;
+
+//	The viewport is kept in fractional cells, so that slow drags and many
+//	small zoom steps don't drift:  it is only rounded by getViewport
+static double zoom = 1.0;
+static double originRow = 0.0, originCol = 0.0;
+
+static pthread_mutex_t viewportLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+void initializeViewport(unsigned int gridRows, unsigned int gridCols)
+{
+	gridNumRows = gridRows;
+	gridNumCols = gridCols;
+	resetViewport();
+}
+
+//	Dimensions of the viewport at the current zoom, in fractional cells
+static void viewportSize(double* numRows, double* numCols)
+{
+	*numRows = gridNumRows / zoom;
+	*numCols = gridNumCols / zoom;
+}
+
+//	Keeps the zoom within its limits and the viewport within the grid
+static void clampViewport(void)
+{
+	unsigned int smallest = (gridNumRows < gridNumCols) ? gridNumRows : gridNumCols;
+	double maxZoom = (smallest > MIN_VIEWPORT_CELLS) ? (double) smallest / MIN_VIEWPORT_CELLS : 1.0;
+	if (zoom < 1.0)
+		zoom = 1.0;
+	else if (zoom > maxZoom)
+		zoom = maxZoom;
+
+	double numRows, numCols;
+	viewportSize(&numRows, &numCols);
+	if (originRow > gridNumRows - numRows)
+		originRow = gridNumRows - numRows;
+	if (originRow < 0.0)
+		originRow = 0.0;
+	if (originCol > gridNumCols - numCols)
+		originCol = gridNumCols - numCols;
+	if (originCol < 0.0)
+		originCol = 0.0;
+}
+
+/*
+ * Copies the viewport, rounded to whole cells, into view.  It always holds
+ * at least one cell and stays within the grid.
+ */
+void getViewport(Viewport* view)
+{
+	pthread_mutex_lock(&viewportLock);
+	double numRows, numCols;
+	viewportSize(&numRows, &numCols);
+	view->firstRow = (unsigned int) (originRow + 0.5);
+	view->firstCol = (unsigned int) (originCol + 0.5);
+	view->numRows = (unsigned int) (numRows + 0.5);
+	view->numCols = (unsigned int) (numCols + 0.5);
+	pthread_mutex_unlock(&viewportLock);
+
+	if (view->numRows == 0)
+		view->numRows = 1;
+	if (view->numCols == 0)
+		view->numCols = 1;
+	if (view->firstRow + view->numRows > gridNumRows)
+		view->firstRow = gridNumRows - view->numRows;
+	if (view->firstCol + view->numCols > gridNumCols)
+		view->firstCol = gridNumCols - view->numCols;
+}
+
+double getViewportZoom(void)
+{
+	pthread_mutex_lock(&viewportLock);
+	double currentZoom = zoom;
+	pthread_mutex_unlock(&viewportLock);
+	return currentZoom;
+}
+
+//	Shows the whole grid again
+void resetViewport(void)
+{
+	pthread_mutex_lock(&viewportLock);
+	zoom = 1.0;
+	originRow = originCol = 0.0;
+	pthread_mutex_unlock(&viewportLock);
+}
+
+/*
+ * Zooms in by factor (out if it is less than 1), keeping the point of the
+ * grid at (anchorRow, anchorCol) where it is in the pane
+ */
+void zoomViewport(double factor, double anchorRow, double anchorCol)
+{
+	pthread_mutex_lock(&viewportLock);
+	double oldRows, oldCols, newRows, newCols;
+	viewportSize(&oldRows, &oldCols);
+	zoom *= factor;
+	clampViewport();
+	viewportSize(&newRows, &newCols);
+
+	//	the anchor stays at the same fraction of the viewport
+	originRow = anchorRow - (anchorRow - originRow) * newRows / oldRows;
+	originCol = anchorCol - (anchorCol - originCol) * newCols / oldCols;
+	clampViewport();
+	pthread_mutex_unlock(&viewportLock);
+}
+
+//	Moves the viewport by the given number of cells (may be fractional)
+void panViewport(double numRows, double numCols)
+{
+	pthread_mutex_lock(&viewportLock);
+	originRow += numRows;
+	originCol += numCols;
+	clampViewport();
+	pthread_mutex_unlock(&viewportLock);
+}
+
+//	Sets the zoom, and centers the viewport on the cell (centerRow, centerCol)
+void centerViewport(double centerRow, double centerCol, double newZoom)
+{
+	pthread_mutex_lock(&viewportLock);
+	zoom = newZoom;
+	clampViewport();
+	double numRows, numCols;
+	viewportSize(&numRows, &numCols);
+	originRow = centerRow - numRows/2;
+	originCol = centerCol - numCols/2;
+	clampViewport();
+	pthread_mutex_unlock(&viewportLock);
+}